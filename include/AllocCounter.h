@@ -0,0 +1,56 @@
+//////////////////////////////////////////////////////////////////////////
+// AllocCounter.h
+//////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+
+// where a counted allocation came from
+enum AllocSource {
+	ALLOC_NEW, // operator new and new[], std containers and strings go through it
+	ALLOC_SDL, // SDL_malloc, SDL_calloc and SDL_realloc, also used by SDL_ttf and SDL_image
+	ALLOC_SOURCE_COUNT
+};
+
+const char* const ALLOC_SOURCE_NAMES[ALLOC_SOURCE_COUNT] = {
+	"new", "SDL_malloc"
+};
+
+// distinct sizes kept while recording, allocations of further sizes are counted but not listed
+const int ALLOC_SIZE_SLOTS = 64;
+
+// heap allocations of the counting thread so far
+struct AllocCount
+{
+	long long allocations;
+	long long bytes;
+};
+
+// allocations of one size from one source
+struct AllocSize
+{
+	AllocSource source;
+	size_t bytes;
+	long long count;
+};
+
+// count every heap allocation of the calling thread from now on, other threads are not counted.
+// a game built with PONG_ALLOC_COUNTER replaces the global operator new and the SDL memory
+// functions, until this is called they only check a flag. call it before SDL_Init, so SDL
+// allocates through the counter. false when the game was built without the counter
+bool startAllocCounter();
+
+AllocCount getAllocCount();
+
+// keep the size of every counted allocation from now on
+void setAllocRecording(bool enabled);
+
+// recorded sizes, most frequent first, returns how many were copied
+int getAllocSizes(AllocSize* sizes, int max);
+
+// recorded allocations whose size found no free slot
+long long getUnlistedAllocs();
+
+// trap into the debugger at the next counted allocation, its call stack is the offender
+void setAllocBreak(bool enabled);
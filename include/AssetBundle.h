@@ -0,0 +1,96 @@
+//////////////////////////////////////////////////////////////////////////
+// AssetBundle.h
+//////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+// file layout, all numbers little endian
+// "PPAK" magic, u32 version, u32 entries, u32 reserved
+// then per entry: char name[32], u32 offset, u32 size, u32 width, u32 height
+// entry data follows, every block starts on a BUNDLE_ALIGN boundary.
+// images are stored as ARGB8888 pixels with the color key already turned
+// into alpha, so they go to the texture as they are
+const char BUNDLE_MAGIC[4] = { 'P', 'P', 'A', 'K' };
+const int BUNDLE_VERSION = 1;
+const int BUNDLE_HEADER_SIZE = 16;
+const int BUNDLE_NAME_LENGTH = 32;
+const int BUNDLE_ENTRY_SIZE = BUNDLE_NAME_LENGTH + 16;
+const int BUNDLE_ALIGN = 16;
+// largest image side, keeps the pitch and the pixel count of an image inside an int
+const unsigned int BUNDLE_MAX_IMAGE_SIDE = 16384;
+// bundle sits next to the executable
+const char* const BUNDLE_FILE_NAME = "Pong.pak";
+// entry names
+const char* const BUNDLE_SPRITE = "sprite";
+const char* const BUNDLE_SPRITE_ATLAS = "sprite_atlas";
+const char* const BUNDLE_FONT = "font";
+
+// one asset of the bundle
+struct BundleEntry
+{
+	char name[BUNDLE_NAME_LENGTH];
+	unsigned int offset;
+	unsigned int size;
+	// pixels for images, 0 for other data
+	unsigned int width;
+	unsigned int height;
+};
+
+// read only view of a whole file, mapped instead of read
+class MappedFile
+{
+public:
+	MappedFile();
+	~MappedFile();
+
+	bool open(std::string path);
+	void close();
+
+	const unsigned char* getData();
+	size_t getSize();
+
+private:
+	const unsigned char* mData;
+	size_t mSize;
+#ifdef _WIN32
+	void* mFile;
+	void* mMapping;
+#endif
+};
+
+// assets packed at build time, used straight from the mapped file
+class AssetBundle
+{
+public:
+	// map bundle and read its entry table
+	bool open(std::string path);
+	void close();
+
+	// entry by name, NULL if there is none
+	const BundleEntry* find(const char* name);
+
+	// first byte of an entry, stays valid until close
+	const unsigned char* getData(const BundleEntry* entry);
+
+private:
+	MappedFile mFile;
+	std::vector<BundleEntry> mEntries;
+};
+
+// collects assets and writes a bundle
+class BundleWriter
+{
+public:
+	// append a copy of data
+	void add(const char* name, const void* data, unsigned int size, unsigned int width = 0, unsigned int height = 0);
+
+	// write to file
+	bool save(std::string path);
+
+private:
+	std::vector<BundleEntry> mEntries;
+	std::vector<unsigned char> mData;
+};
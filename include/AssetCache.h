@@ -0,0 +1,463 @@
+//////////////////////////////////////////////////////////////////////////
+// AssetCache.h
+//////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/inotify.h>
+#endif // __linux__
+
+#include <SDL/SDL.h>
+#include <SDL/SDL_image.h>
+#include <SDL/SDL_ttf.h>
+
+// what an asset holds
+enum AssetKind {
+	ASSET_TEXTURE,
+	ASSET_FONT
+};
+
+// one loaded asset, shared by everyone who acquired it.
+// a reload replaces the contents in place, so read texture and font when
+// using them instead of keeping copies; version tells when derived data,
+// like a glyph atlas, has to be built again
+struct CachedAsset
+{
+	AssetKind kind;
+	// file, or a name for pixels that came from memory
+	std::string path;
+	// fonts of one file in different sizes are different assets
+	int fontSize;
+	// whether path is a file that is watched and reloaded
+	bool isFile;
+	int refs;
+	int version;
+
+	// texture, ARGB8888, pixels of the color key become transparent
+	SDL_Texture* texture;
+	bool keyed;
+	SDL_Color colorKey;
+	int width;
+	int height;
+	size_t gpuBytes;
+
+	TTF_Font* font;
+};
+
+// textures and fonts keyed by path, loaded once however often they are asked for.
+// on linux, files are watched with inotify and changed ones are loaded again
+class AssetCache
+{
+public:
+	AssetCache();
+
+	// frees everything
+	~AssetCache();
+
+	// renderer creates the textures, hotReload watches the files
+	void init(SDL_Renderer* renderer, bool hotReload);
+
+	// image file, pixels of colorKey become transparent, NULL when it cannot be loaded.
+	// the key is part of the cache key, one file keyed two ways is two textures
+	CachedAsset* acquireTexture(const std::string& path, const SDL_Color* colorKey = NULL);
+
+	// ARGB8888 pixels already in memory, name is the key, never reloaded
+	CachedAsset* acquirePixels(const std::string& name, const void* pixels, int width, int height);
+
+	// font file in size
+	CachedAsset* acquireFont(const std::string& path, int size);
+
+	// the last release frees the asset
+	void release(CachedAsset* asset);
+
+	// load changed files again, call once a frame, returns how many assets changed
+	int poll();
+
+	// memory of every texture in the cache
+	size_t getGpuBytes();
+
+	// assets in the cache, files loaded and requests served from the cache
+	int getCount();
+	int getLoads();
+	int getHits();
+
+	// one line per asset and the totals, to stdout
+	void printUsage();
+
+	// free every asset, handed out ones included, and stop watching
+	void freeCache();
+
+private:
+	AssetCache(const AssetCache&);
+	AssetCache& operator=(const AssetCache&);
+
+	CachedAsset* find(AssetKind kind, const std::string& path, int fontSize);
+	CachedAsset* findTexture(const std::string& path, const SDL_Color* colorKey);
+	CachedAsset* create(AssetKind kind, const std::string& path, int fontSize, bool isFile);
+
+	// read the file of asset into it, the old contents stay when it fails
+	bool loadTexture(CachedAsset* asset);
+	bool loadFont(CachedAsset* asset);
+
+	// upload pixels, into the old texture when the size did not change
+	bool uploadPixels(CachedAsset* asset, const void* pixels, int width, int height, int pitch);
+
+	void freeAsset(CachedAsset* asset);
+
+	// watch the directory of path, editors often replace a file instead of writing it
+	void watch(const std::string& path);
+
+	SDL_Renderer* mRenderer;
+	std::vector<CachedAsset*> mAssets;
+	int mLoads;
+	int mHits;
+
+	// inotify descriptor, -1 without hot reload
+	int mNotify;
+	std::vector<int> mWatches;
+	// directory of each watch as it starts asset paths, empty or ending in a slash
+	std::vector<std::string> mWatchedPrefixes;
+};
+
+AssetCache::AssetCache() {
+	mRenderer = NULL;
+	mLoads = 0;
+	mHits = 0;
+	mNotify = -1;
+}
+
+AssetCache::~AssetCache() {
+	freeCache();
+}
+
+void AssetCache::init(SDL_Renderer* renderer, bool hotReload) {
+	mRenderer = renderer;
+	if (!hotReload || mNotify >= 0) {
+		return;
+	}
+#ifdef __linux__
+	mNotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (mNotify < 0) {
+		printf("Unable to watch assets, inotify failed!\n");
+	}
+#else
+	printf("Hot reload needs inotify, assets are loaded once!\n");
+#endif // __linux__
+}
+
+CachedAsset* AssetCache::acquireTexture(const std::string& path, const SDL_Color* colorKey) {
+	CachedAsset* asset = findTexture(path, colorKey);
+	if (asset != NULL) {
+		mHits++;
+		asset->refs++;
+		return asset;
+	}
+	asset = create(ASSET_TEXTURE, path, 0, true);
+	if (colorKey != NULL) {
+		asset->keyed = true;
+		asset->colorKey = *colorKey;
+	}
+	if (!loadTexture(asset)) {
+		freeAsset(asset);
+		return NULL;
+	}
+	watch(path);
+	return asset;
+}
+
+CachedAsset* AssetCache::acquirePixels(const std::string& name, const void* pixels, int width, int height) {
+	CachedAsset* asset = find(ASSET_TEXTURE, name, 0);
+	if (asset != NULL) {
+		mHits++;
+		asset->refs++;
+		return asset;
+	}
+	asset = create(ASSET_TEXTURE, name, 0, false);
+	if (!uploadPixels(asset, pixels, width, height, width * 4)) {
+		freeAsset(asset);
+		return NULL;
+	}
+	mLoads++;
+	return asset;
+}
+
+CachedAsset* AssetCache::acquireFont(const std::string& path, int size) {
+	CachedAsset* asset = find(ASSET_FONT, path, size);
+	if (asset != NULL) {
+		mHits++;
+		asset->refs++;
+		return asset;
+	}
+	asset = create(ASSET_FONT, path, size, true);
+	if (!loadFont(asset)) {
+		freeAsset(asset);
+		return NULL;
+	}
+	watch(path);
+	return asset;
+}
+
+void AssetCache::release(CachedAsset* asset) {
+	if (asset != NULL && --asset->refs <= 0) {
+		freeAsset(asset);
+	}
+}
+
+int AssetCache::poll() {
+	int changed = 0;
+#ifdef __linux__
+	if (mNotify < 0) {
+		return 0;
+	}
+	// a save often brings several events for one file, reload each asset once
+	std::vector<CachedAsset*> dirty;
+	alignas(struct inotify_event) char buffer[4096];
+	while (true) {
+		ssize_t length = read(mNotify, buffer, sizeof(buffer));
+		if (length <= 0) {
+			break;
+		}
+		for (ssize_t offset = 0; offset < length; ) {
+			const struct inotify_event* event = (const struct inotify_event*)(buffer + offset);
+			offset += sizeof(struct inotify_event) + event->len;
+			if (event->len == 0) {
+				continue;
+			}
+			for (size_t w = 0; w < mWatches.size(); w++) {
+				if (mWatches[w] != event->wd) {
+					continue;
+				}
+				std::string path = mWatchedPrefixes[w] + event->name;
+				for (size_t i = 0; i < mAssets.size(); i++) {
+					if (mAssets[i]->isFile && mAssets[i]->path == path &&
+						std::find(dirty.begin(), dirty.end(), mAssets[i]) == dirty.end()) {
+						dirty.push_back(mAssets[i]);
+					}
+				}
+			}
+		}
+	}
+	for (size_t i = 0; i < dirty.size(); i++) {
+		bool success = dirty[i]->kind == ASSET_TEXTURE ? loadTexture(dirty[i]) : loadFont(dirty[i]);
+		if (success) {
+			printf("Reloaded %s.\n", dirty[i]->path.c_str());
+			changed++;
+		}
+	}
+#endif // __linux__
+	return changed;
+}
+
+size_t AssetCache::getGpuBytes() {
+	size_t bytes = 0;
+	for (size_t i = 0; i < mAssets.size(); i++) {
+		bytes += mAssets[i]->gpuBytes;
+	}
+	return bytes;
+}
+
+int AssetCache::getCount() {
+	return (int)mAssets.size();
+}
+
+int AssetCache::getLoads() {
+	return mLoads;
+}
+
+int AssetCache::getHits() {
+	return mHits;
+}
+
+void AssetCache::printUsage() {
+	for (size_t i = 0; i < mAssets.size(); i++) {
+		const CachedAsset* asset = mAssets[i];
+		if (asset->kind == ASSET_TEXTURE) {
+			printf("  texture %s %dx%d, %u KB, %d refs, version %d\n", asset->path.c_str(), asset->width, asset->height,
+				(unsigned int)(asset->gpuBytes / 1024), asset->refs, asset->version);
+		} else {
+			printf("  font %s size %d, %d refs, version %d\n", asset->path.c_str(), asset->fontSize, asset->refs, asset->version);
+		}
+	}
+	printf("asset cache: %d assets, %u KB of textures, %d loads, %d served from the cache\n", getCount(),
+		(unsigned int)(getGpuBytes() / 1024), mLoads, mHits);
+}
+
+void AssetCache::freeCache() {
+	while (!mAssets.empty()) {
+		freeAsset(mAssets.back());
+	}
+#ifdef __linux__
+	if (mNotify >= 0) {
+		// closing drops every watch
+		close(mNotify);
+		mNotify = -1;
+	}
+#endif // __linux__
+	mWatches.clear();
+	mWatchedPrefixes.clear();
+}
+
+CachedAsset* AssetCache::find(AssetKind kind, const std::string& path, int fontSize) {
+	for (size_t i = 0; i < mAssets.size(); i++) {
+		if (mAssets[i]->kind == kind && mAssets[i]->fontSize == fontSize && mAssets[i]->path == path) {
+			return mAssets[i];
+		}
+	}
+	return NULL;
+}
+
+CachedAsset* AssetCache::findTexture(const std::string& path, const SDL_Color* colorKey) {
+	for (size_t i = 0; i < mAssets.size(); i++) {
+		const CachedAsset* asset = mAssets[i];
+		if (asset->kind != ASSET_TEXTURE || !asset->isFile || asset->path != path || asset->keyed != (colorKey != NULL)) {
+			continue;
+		}
+		// alpha of the key is not used
+		if (colorKey == NULL || (asset->colorKey.r == colorKey->r && asset->colorKey.g == colorKey->g && asset->colorKey.b == colorKey->b)) {
+			return mAssets[i];
+		}
+	}
+	return NULL;
+}
+
+CachedAsset* AssetCache::create(AssetKind kind, const std::string& path, int fontSize, bool isFile) {
+	CachedAsset* asset = new CachedAsset();
+	asset->kind = kind;
+	asset->path = path;
+	asset->fontSize = fontSize;
+	asset->isFile = isFile;
+	asset->refs = 1;
+	asset->version = 0;
+	asset->texture = NULL;
+	asset->keyed = false;
+	asset->colorKey.r = 0;
+	asset->colorKey.g = 0;
+	asset->colorKey.b = 0;
+	asset->colorKey.a = 0;
+	asset->width = 0;
+	asset->height = 0;
+	asset->gpuBytes = 0;
+	asset->font = NULL;
+	mAssets.push_back(asset);
+	return asset;
+}
+
+bool AssetCache::loadTexture(CachedAsset* asset) {
+	SDL_Surface* loadedSurface = IMG_Load(asset->path.c_str());
+	if (loadedSurface == NULL) {
+		printf("Unable to load image %s! SDL_image Error: %s\n", asset->path.c_str(), IMG_GetError());
+		return false;
+	}
+	if (asset->keyed) {
+		SDL_SetColorKey(loadedSurface, SDL_TRUE, SDL_MapRGB(loadedSurface->format, asset->colorKey.r, asset->colorKey.g, asset->colorKey.b));
+	}
+
+	// copy onto transparent ARGB8888, keyed pixels are skipped and stay transparent
+	bool success = false;
+	SDL_Surface* converted = SDL_CreateRGBSurfaceWithFormat(0, loadedSurface->w, loadedSurface->h, 32, SDL_PIXELFORMAT_ARGB8888);
+	if (converted == NULL) {
+		printf("Unable to convert %s! SDL Error: %s\n", asset->path.c_str(), SDL_GetError());
+	} else {
+		SDL_FillRect(converted, NULL, 0);
+		SDL_SetSurfaceBlendMode(loadedSurface, SDL_BLENDMODE_NONE);
+		SDL_BlitSurface(loadedSurface, NULL, converted, NULL);
+		success = uploadPixels(asset, converted->pixels, converted->w, converted->h, converted->pitch);
+		SDL_FreeSurface(converted);
+	}
+	SDL_FreeSurface(loadedSurface);
+	if (success) {
+		mLoads++;
+	}
+	return success;
+}
+
+bool AssetCache::loadFont(CachedAsset* asset) {
+	TTF_Font* font = TTF_OpenFont(asset->path.c_str(), asset->fontSize);
+	if (font == NULL) {
+		printf("Unable to load font %s! SDL_ttf Error: %s\n", asset->path.c_str(), TTF_GetError());
+		return false;
+	}
+	if (asset->font != NULL) {
+		TTF_CloseFont(asset->font);
+	}
+	asset->font = font;
+	asset->version++;
+	mLoads++;
+	return true;
+}
+
+bool AssetCache::uploadPixels(CachedAsset* asset, const void* pixels, int width, int height, int pitch) {
+	SDL_Texture* texture = asset->texture;
+	// a new size needs a new texture, everyone reads it from the asset
+	if (texture == NULL || width != asset->width || height != asset->height) {
+		texture = SDL_CreateTexture(mRenderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STATIC, width, height);
+		if (texture == NULL) {
+			printf("Unable to create texture for %s! SDL Error: %s\n", asset->path.c_str(), SDL_GetError());
+			return false;
+		}
+		SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+	}
+	if (SDL_UpdateTexture(texture, NULL, pixels, pitch) != 0) {
+		printf("Unable to upload %s! SDL Error: %s\n", asset->path.c_str(), SDL_GetError());
+		if (texture != asset->texture) {
+			SDL_DestroyTexture(texture);
+		}
+		return false;
+	}
+	if (texture != asset->texture && asset->texture != NULL) {
+		SDL_DestroyTexture(asset->texture);
+	}
+	asset->texture = texture;
+	asset->width = width;
+	asset->height = height;
+	asset->gpuBytes = (size_t)width * height * 4;
+	asset->version++;
+	return true;
+}
+
+void AssetCache::freeAsset(CachedAsset* asset) {
+	size_t index = std::find(mAssets.begin(), mAssets.end(), asset) - mAssets.begin();
+	if (index == mAssets.size()) {
+		return;
+	}
+	if (asset->texture != NULL) {
+		SDL_DestroyTexture(asset->texture);
+	}
+	if (asset->font != NULL) {
+		TTF_CloseFont(asset->font);
+	}
+	mAssets.erase(mAssets.begin() + index);
+	delete asset;
+}
+
+void AssetCache::watch(const std::string& path) {
+#ifdef __linux__
+	if (mNotify < 0) {
+		return;
+	}
+	size_t slash = path.find_last_of('/');
+	std::string prefix = slash == std::string::npos ? "" : path.substr(0, slash + 1);
+	std::string directory = slash == std::string::npos ? "." : path.substr(0, slash);
+	for (size_t i = 0; i < mWatchedPrefixes.size(); i++) {
+		if (mWatchedPrefixes[i] == prefix) {
+			return;
+		}
+	}
+	// written in place or moved over the old file
+	int watch = inotify_add_watch(mNotify, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+	if (watch < 0) {
+		printf("Unable to watch %s!\n", directory.c_str());
+		return;
+	}
+	mWatches.push_back(watch);
+	mWatchedPrefixes.push_back(prefix);
+#endif // __linux__
+}
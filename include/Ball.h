@@ -4,50 +4,49 @@
 
 #pragma once
 
-#include "../include/Tools.h"
+#include "../include/SpriteBatch.h"
 
 class Ball
 {
 public:
 	Ball();
 	// constructor
-	Ball(int x, int y, LTexture* texture, SDL_Rect* clip, int radius = 0, int velX = 0, int velY = 0);
+	Ball(float x, float y, const SDL_Rect* clip, int radius = 0, float velX = 0, float velY = 0);
 
 	// move
 	void move();
 
-	// draw
-	void draw(SDL_Renderer* renderer);
+	// queue into the sprite batch
+	void draw(SpriteBatch* batch);
 
 	// set center position
-	void setCenter(int x, int y);
+	void setCenter(float x, float y);
 
 	// set velocity
-	void setVelocity(int x, int y);
+	void setVelocity(float x, float y);
 
 	// getter
-	int getCenterX();
-	int getCenterY();
-	int getVelocityX();
-	int getVelocityY();
+	float getCenterX();
+	float getCenterY();
+	float getVelocityX();
+	float getVelocityY();
 	int getRadius();
 
 	~Ball();
 
 private:
-	// center position
-	int mCenterX;
-	int mCenterY;
+	// center position in pixels, between two simulation ticks while interpolating
+	float mCenterX;
+	float mCenterY;
 	// velocity
-	int mVelocityX;
-	int mVelocityY;
+	float mVelocityX;
+	float mVelocityY;
 
 	// dimension
 	int mRadius;
 
-	// texture
-	LTexture* mTexture;
-	SDL_Rect* mClip;
+	// clip in the sprite sheet
+	const SDL_Rect* mClip;
 };
 
 Ball::Ball()
@@ -58,8 +57,8 @@ Ball::~Ball()
 {
 }
 
-Ball::Ball(int x, int y, LTexture* texture, SDL_Rect* clip, int radius, int velX, int velY):
-	mCenterX(x),mCenterY(y),mTexture(texture),mClip(clip),mRadius(radius),mVelocityX(velX),mVelocityY(velY){
+Ball::Ball(float x, float y, const SDL_Rect* clip, int radius, float velX, float velY):
+	mCenterX(x),mCenterY(y),mClip(clip),mRadius(radius),mVelocityX(velX),mVelocityY(velY){
 	if (radius == 0) {
 		mRadius = clip->w / 2;
 	}
@@ -70,33 +69,33 @@ void Ball::move() {
 	mCenterY += mVelocityY;
 }
 
-void Ball::draw(SDL_Renderer* renderer) {
-	mTexture->render(renderer, mCenterX - mRadius, mCenterY - mRadius, mClip);
+void Ball::draw(SpriteBatch* batch) {
+	batch->draw(mClip, mCenterX - mRadius, mCenterY - mRadius);
 }
 
-void Ball::setCenter(int x, int y) {
+void Ball::setCenter(float x, float y) {
 	mCenterX = x;
 	mCenterY = y;
 }
 
-void Ball::setVelocity(int x, int y) {
+void Ball::setVelocity(float x, float y) {
 	mVelocityX = x;
 	mVelocityY = y;
 }
 
-int Ball::getCenterX() {
+float Ball::getCenterX() {
 	return mCenterX;
 }
 
-int Ball::getCenterY() {
+float Ball::getCenterY() {
 	return mCenterY;
 }
 
-int Ball::getVelocityX() {
+float Ball::getVelocityX() {
 	return mVelocityX;
 }
 
-int Ball::getVelocityY() {
+float Ball::getVelocityY() {
 	return mVelocityY;
 }
 
@@ -0,0 +1,83 @@
+//////////////////////////////////////////////////////////////////////////
+// BatchWorld.h
+//////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+
+#include "../include/Simulation.h"
+
+// alignment of every array, one cache line
+const int BATCH_ALIGN = 64;
+
+// K independent matches stored as structure of arrays,
+// stepped together by branch free kernels the compiler can vectorize
+class BatchWorld
+{
+public:
+	// constructor, match i serves with seed + i like playMatch
+	BatchWorld(int count, unsigned int seed = 0);
+
+	~BatchWorld();
+
+	// reset every match
+	void reset();
+
+	// reset one match
+	void resetMatch(int i);
+
+	// advance every match one tick
+	// actions: player sticky direction per match (-1, 0, 1), NULL lets the computer play
+	// finished matches are reset at the end of the tick
+	void step(const int* actions = NULL);
+
+	// number of matches
+	int getCount() const;
+
+	// state arrays, getCount() entries each, units as in SimState
+	const int* getBallX() const;
+	const int* getBallY() const;
+	const int* getBallVelocityX() const;
+	const int* getBallVelocityY() const;
+	const int* getComputerX() const;
+	const int* getComputerVelocityX() const;
+	const int* getPlayerX() const;
+	const int* getPlayerVelocityX() const;
+	const int* getPlayerScore() const;
+	const int* getComputerScore() const;
+	// TickResult of the last step
+	const int* getResult() const;
+
+	// copy match i into a single simulation state
+	void getState(int i, SimState* state) const;
+
+private:
+	BatchWorld(const BatchWorld&);
+	BatchWorld& operator=(const BatchWorld&);
+
+	int mCount;
+	unsigned int mSeed;
+
+	// one aligned block holding every array
+	char* mBlock;
+
+	// ball
+	int* mBallX;
+	int* mBallY;
+	int* mBallVelX;
+	int* mBallVelY;
+	int* mBallSpeed;
+	int* mStart;
+	// stickies, y is fixed
+	int* mComputerX;
+	int* mComputerVelX;
+	int* mPlayerX;
+	int* mPlayerVelX;
+	// score
+	int* mPlayerScore;
+	int* mComputerScore;
+	int* mResult;
+	// serve random state
+	unsigned int* mServeSeed;
+};
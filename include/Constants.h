@@ -8,11 +8,14 @@
 // window setting
 const int WINDOW_WIDTH = 500;
 const int WINDOW_HEIGHT = 400;
-const char* WINDOW_CAPTION = "Pong";
+const char* const WINDOW_CAPTION = "Pong";
 
 // game setting
-const int FRAMES_PER_SECOND = 30;
-const int FRAME_RATE = 1000/FRAMES_PER_SECOND;
+const int FRAMES_PER_SECOND = 60; // render rate when the display refresh rate is unknown
+const int FRAME_SPIN_MS = 2; // spin instead of sleep for the last milliseconds of a frame
+const int FRAME_LATCH_MARGIN_MS = 1; // low latency mode reads input this much earlier than the late part of a frame needs
+const int STATIC_WAIT_MS = 500; // longest sleep on a screen waiting for input
+const int PROFILER_REFRESH_FRAMES = 15; // timing overlay update interval
 // game area setting
 const int GAME_AREA_LEFT = 0;
 const int GAME_AREA_RIGHT = WINDOW_WIDTH;
@@ -20,13 +23,19 @@ const int GAME_AREA_BOTTOM = WINDOW_HEIGHT;
 const int GAME_AREA_TOP = 20;
 const int SCORE = 5;
 
-// sprite image related
-const int COMPUTER_IMG_X = 0;
-const int COMPUTER_IMG_Y = 0;
-const int PLAYER_IMG_X = 0;
-const int PLAYER_IMG_Y = 16;
-const int BALL_IMG_X = 68;
-const int BALL_IMG_Y = 1;
+// physics setting
+// the simulation ticks at a fixed rate of its own, rendering interpolates between the last two ticks
+const int TICKS_PER_SECOND = 240;
+const int MAX_TICKS_PER_FRAME = 24; // a longer frame drops the rest instead of catching up
+// positions, dimensions and velocities of the simulation are fixed point
+const int SUBPIXEL_SHIFT = 8;
+const int SUBPIXELS = 1 << SUBPIXEL_SHIFT; // units per pixel
+
+// sprite image related, clips are in the atlas file next to the image
+const unsigned int SPRITE_COLOR_KEY = 0xFF00FF; // rgb shown as transparent
+const char* const SPRITE_COMPUTER_STICKY = "computer_sticky";
+const char* const SPRITE_PLAYER_STICKY = "player_sticky";
+const char* const SPRITE_BALL = "ball";
 // dimensions
 const int STICKY_WIDTH = 60;
 const int STICKY_HEIGHT = 15;
@@ -38,7 +47,23 @@ const int PLAYER_START_X = (WINDOW_WIDTH - STICKY_WIDTH) / 2;
 const int PLAYER_START_Y = (GAME_AREA_BOTTOM - STICKY_HEIGHT);
 const int BALL_START_X = WINDOW_WIDTH / 2;
 const int BALL_START_Y = (GAME_AREA_TOP+GAME_AREA_BOTTOM) / 2;
-// speed
+// speed, pixels per 1/30 second the game was tuned at
+const int SPEED_FRAMES_PER_SECOND = 30;
 const int BALL_INIT_SPEED = 5;
 const int BALL_CHANGE_SPEED = 1;
-const int STICKY_SPEED = 5;	
+const int BALL_MAX_SPEED = 40;
+const int STICKY_SPEED = 5;
+// one speed step in subpixels per tick, exact while TICKS_PER_SECOND divides 7680
+const int SPEED_SCALE = SUBPIXELS * SPEED_FRAMES_PER_SECOND / TICKS_PER_SECOND;
+const int BALL_INIT_VELOCITY = BALL_INIT_SPEED * SPEED_SCALE;
+const int BALL_CHANGE_VELOCITY = BALL_CHANGE_SPEED * SPEED_SCALE;
+const int BALL_MAX_VELOCITY = BALL_MAX_SPEED * SPEED_SCALE;
+const int STICKY_VELOCITY = STICKY_SPEED * SPEED_SCALE;
+// headless setting
+const long long MAX_MATCH_TICKS = 8000000;
+const int SERVE_MAX_SPEED_X = 2;
+
+// pixels to simulation units
+inline int toSubpixels(int pixels) {
+	return pixels * SUBPIXELS;
+}
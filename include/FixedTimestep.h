@@ -0,0 +1,71 @@
+//////////////////////////////////////////////////////////////////////////
+// FixedTimestep.h
+//////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <SDL/SDL.h>
+
+#include "../include/Constants.h"
+
+// turns elapsed time into whole simulation ticks, independent of the frame rate
+// the part of a tick left over is kept for the next frame and for interpolation
+class FixedTimestep
+{
+public:
+	FixedTimestep();
+
+	// simulation ticks per second
+	void init(int ticksPerSecond);
+
+	// count from now on, time spent outside the game is not simulated
+	void reset();
+
+	// ticks due since the last call, at most MAX_TICKS_PER_FRAME
+	int advance();
+
+	// elapsed part of the next tick, 0 to 1
+	float getAlpha();
+
+private:
+	Uint64 mFrequency;
+	Uint64 mRate;
+	Uint64 mLast;
+	// elapsed counter ticks times mRate, one simulation tick per mFrequency, no rounding drift
+	Uint64 mAccumulator;
+};
+
+FixedTimestep::FixedTimestep() {
+	mFrequency = 1;
+	mRate = 1;
+	mLast = 0;
+	mAccumulator = 0;
+}
+
+void FixedTimestep::init(int ticksPerSecond) {
+	mFrequency = SDL_GetPerformanceFrequency();
+	mRate = ticksPerSecond;
+	reset();
+}
+
+void FixedTimestep::reset() {
+	mLast = SDL_GetPerformanceCounter();
+	mAccumulator = 0;
+}
+
+int FixedTimestep::advance() {
+	Uint64 now = SDL_GetPerformanceCounter();
+	mAccumulator += (now - mLast) * mRate;
+	mLast = now;
+	Uint64 ticks = mAccumulator / mFrequency;
+	mAccumulator -= ticks * mFrequency;
+	// a long stall would make the simulation jump, drop the time instead
+	if (ticks > (Uint64)MAX_TICKS_PER_FRAME) {
+		ticks = MAX_TICKS_PER_FRAME;
+	}
+	return (int)ticks;
+}
+
+float FixedTimestep::getAlpha() {
+	return (float)((double)mAccumulator / mFrequency);
+}
@@ -0,0 +1,326 @@
+//////////////////////////////////////////////////////////////////////////
+// FrameCapture.h
+//////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include <SDL/SDL.h>
+#include <SDL/SDL_image.h>
+
+// offscreen frames, each is read back just before it is drawn again,
+// by then the gpu finished it long ago
+const int CAPTURE_TARGETS = 3;
+// read back frames waiting for the encoder, more are dropped, the game never waits
+const int CAPTURE_RING = 8;
+// video rate, the game renders at the display rate
+const int CAPTURE_FRAMES_PER_SECOND = 30;
+
+// how captured frames are written
+enum CaptureFormat {
+	CAPTURE_RAW, // every frame appended to frames.raw, ARGB8888 rows, bgra bytes
+	CAPTURE_PNG // frame_000000.png, frame_000001.png, ...
+};
+
+// records gameplay without stalling the frame.
+// frames are drawn into a ring of target textures and copied to the window,
+// a target is read back only when the ring comes around to it again, into a
+// staging buffer the encoder thread writes to disk
+class FrameCapture
+{
+public:
+	FrameCapture();
+
+	// stops recording
+	~FrameCapture();
+
+	// create targets and staging buffers in directory, which has to exist, and start the encoder
+	bool start(SDL_Renderer* renderer, int width, int height, const std::string& directory, CaptureFormat format, int framesPerSecond);
+
+	// read back the frames still in the targets, wait for the encoder and free everything
+	void stop();
+
+	bool isRecording();
+
+	// draw the frame into the next target, nothing happens when not recording
+	void beginFrame();
+
+	// copy the frame onto the window, call right before present
+	void endFrame();
+
+	// after present, read back the oldest target if its frame is due for the video
+	void collect();
+
+	// frames written and frames lost because the encoder fell behind
+	int getWritten();
+	int getDropped();
+
+private:
+	// read target into a staging buffer and hand it to the encoder
+	void readBack(int target);
+
+	// encoder thread
+	void encode();
+	bool writeFrame(const unsigned char* pixels, int number);
+
+	SDL_Renderer* mRenderer;
+	SDL_Texture* mTargets[CAPTURE_TARGETS];
+	// video frame number a target holds, -1 when it is not part of the video
+	int mTargetFrames[CAPTURE_TARGETS];
+	// target of the current frame
+	int mTarget;
+	int mWidth;
+	int mHeight;
+
+	// capture clock
+	Uint64 mPeriod;
+	Uint64 mNextCapture;
+	int mFrameNumber;
+
+	// CAPTURE_RING staging buffers, [mFirst, mFirst + mQueued) wait for the encoder
+	std::vector<unsigned char> mPixels;
+	int mStagingNumbers[CAPTURE_RING];
+	int mFirst;
+	int mQueued;
+	bool mStopping;
+	int mWritten;
+	int mDropped;
+	std::mutex mMutex;
+	std::condition_variable mWake;
+	std::thread mEncoder;
+
+	std::string mDirectory;
+	CaptureFormat mFormat;
+	FILE* mRaw;
+};
+
+FrameCapture::FrameCapture() {
+	mRenderer = NULL;
+	for (int i = 0; i < CAPTURE_TARGETS; i++) {
+		mTargets[i] = NULL;
+		mTargetFrames[i] = -1;
+	}
+	mTarget = 0;
+	mWidth = 0;
+	mHeight = 0;
+	mPeriod = 0;
+	mNextCapture = 0;
+	mFrameNumber = 0;
+	mFirst = 0;
+	mQueued = 0;
+	mStopping = false;
+	mWritten = 0;
+	mDropped = 0;
+	mFormat = CAPTURE_RAW;
+	mRaw = NULL;
+}
+
+FrameCapture::~FrameCapture() {
+	stop();
+}
+
+bool FrameCapture::start(SDL_Renderer* renderer, int width, int height, const std::string& directory, CaptureFormat format, int framesPerSecond) {
+	stop();
+	if (!SDL_RenderTargetSupported(renderer)) {
+		printf("Unable to capture frames, renderer has no render targets!\n");
+		return false;
+	}
+	mRenderer = renderer;
+	mWidth = width;
+	mHeight = height;
+	mDirectory = directory;
+	mFormat = format;
+	for (int i = 0; i < CAPTURE_TARGETS; i++) {
+		mTargets[i] = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, width, height);
+		mTargetFrames[i] = -1;
+		if (mTargets[i] == NULL) {
+			printf("Unable to create capture target! SDL Error: %s\n", SDL_GetError());
+			stop();
+			return false;
+		}
+	}
+	if (format == CAPTURE_RAW) {
+		std::string path = directory + "/frames.raw";
+		mRaw = fopen(path.c_str(), "wb");
+		if (mRaw == NULL) {
+			printf("Unable to open %s!\n", path.c_str());
+			stop();
+			return false;
+		}
+	}
+	mPixels.assign((size_t)CAPTURE_RING * width * height * 4, 0);
+	mTarget = 0;
+	mPeriod = SDL_GetPerformanceFrequency() / (framesPerSecond > 0 ? framesPerSecond : CAPTURE_FRAMES_PER_SECOND);
+	mNextCapture = SDL_GetPerformanceCounter();
+	mFrameNumber = 0;
+	mFirst = 0;
+	mQueued = 0;
+	mStopping = false;
+	mWritten = 0;
+	mDropped = 0;
+	mEncoder = std::thread(&FrameCapture::encode, this);
+	return true;
+}
+
+void FrameCapture::stop() {
+	if (mRenderer != NULL && mEncoder.joinable()) {
+		// frames still waiting in the targets, oldest first
+		for (int i = 1; i <= CAPTURE_TARGETS; i++) {
+			readBack((mTarget + i) % CAPTURE_TARGETS);
+		}
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			mStopping = true;
+		}
+		mWake.notify_one();
+		mEncoder.join();
+		printf("Captured %d frames, dropped %d.\n", mWritten, mDropped);
+	}
+	for (int i = 0; i < CAPTURE_TARGETS; i++) {
+		if (mTargets[i] != NULL) {
+			SDL_DestroyTexture(mTargets[i]);
+			mTargets[i] = NULL;
+		}
+	}
+	if (mRaw != NULL) {
+		fclose(mRaw);
+		mRaw = NULL;
+	}
+	std::vector<unsigned char>().swap(mPixels);
+	mRenderer = NULL;
+}
+
+bool FrameCapture::isRecording() {
+	return mRenderer != NULL;
+}
+
+void FrameCapture::beginFrame() {
+	if (mRenderer == NULL) {
+		return;
+	}
+	// frames between two video frames are drawn the same way but not read back
+	Uint64 now = SDL_GetPerformanceCounter();
+	mTargetFrames[mTarget] = -1;
+	if (now >= mNextCapture) {
+		mTargetFrames[mTarget] = mFrameNumber++;
+		mNextCapture += mPeriod;
+		// a stall does not make a burst of frames
+		if (now >= mNextCapture) {
+			mNextCapture = now + mPeriod;
+		}
+	}
+	SDL_SetRenderTarget(mRenderer, mTargets[mTarget]);
+}
+
+void FrameCapture::endFrame() {
+	if (mRenderer == NULL) {
+		return;
+	}
+	SDL_SetRenderTarget(mRenderer, NULL);
+	SDL_RenderCopy(mRenderer, mTargets[mTarget], NULL, NULL);
+}
+
+void FrameCapture::collect() {
+	if (mRenderer == NULL) {
+		return;
+	}
+	// the next frame draws into the oldest target, take its frame out first
+	mTarget = (mTarget + 1) % CAPTURE_TARGETS;
+	readBack(mTarget);
+}
+
+int FrameCapture::getWritten() {
+	std::lock_guard<std::mutex> lock(mMutex);
+	return mWritten;
+}
+
+int FrameCapture::getDropped() {
+	std::lock_guard<std::mutex> lock(mMutex);
+	return mDropped;
+}
+
+void FrameCapture::readBack(int target) {
+	int number = mTargetFrames[target];
+	if (number < 0) {
+		return;
+	}
+	mTargetFrames[target] = -1;
+	int slot;
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		if (mQueued == CAPTURE_RING) {
+			mDropped++;
+			return;
+		}
+		slot = (mFirst + mQueued) % CAPTURE_RING;
+	}
+	// the encoder does not look at the slot until it is queued
+	int pitch = mWidth * 4;
+	unsigned char* pixels = &mPixels[(size_t)slot * pitch * mHeight];
+	SDL_SetRenderTarget(mRenderer, mTargets[target]);
+	int result = SDL_RenderReadPixels(mRenderer, NULL, SDL_PIXELFORMAT_ARGB8888, pixels, pitch);
+	SDL_SetRenderTarget(mRenderer, NULL);
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		if (result != 0) {
+			mDropped++;
+			return;
+		}
+		mStagingNumbers[slot] = number;
+		mQueued++;
+	}
+	mWake.notify_one();
+}
+
+void FrameCapture::encode() {
+	size_t frameSize = (size_t)mWidth * mHeight * 4;
+	std::unique_lock<std::mutex> lock(mMutex);
+	while (true) {
+		while (mQueued == 0 && !mStopping) {
+			mWake.wait(lock);
+		}
+		if (mQueued == 0) {
+			// stopping and nothing left
+			return;
+		}
+		// the slot stays queued while it is written, so it is not filled again
+		int slot = mFirst;
+		int number = mStagingNumbers[slot];
+		lock.unlock();
+		bool written = writeFrame(&mPixels[slot * frameSize], number);
+		lock.lock();
+		mFirst = (mFirst + 1) % CAPTURE_RING;
+		mQueued--;
+		if (written) {
+			mWritten++;
+		} else {
+			mDropped++;
+		}
+	}
+}
+
+bool FrameCapture::writeFrame(const unsigned char* pixels, int number) {
+	int pitch = mWidth * 4;
+	if (mFormat == CAPTURE_RAW) {
+		return fwrite(pixels, pitch, mHeight, mRaw) == (size_t)mHeight;
+	}
+	char name[32];
+	snprintf(name, sizeof(name), "/frame_%06d.png", number);
+	std::string path = mDirectory + name;
+	SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormatFrom((void*)pixels, mWidth, mHeight, 32, pitch, SDL_PIXELFORMAT_ARGB8888);
+	if (surface == NULL) {
+		return false;
+	}
+	bool success = IMG_SavePNG(surface, path.c_str()) == 0;
+	SDL_FreeSurface(surface);
+	if (!success) {
+		printf("Unable to save %s! SDL_image Error: %s\n", path.c_str(), IMG_GetError());
+	}
+	return success;
+}
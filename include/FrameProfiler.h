@@ -0,0 +1,406 @@
+//////////////////////////////////////////////////////////////////////////
+// FrameProfiler.h
+//////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+
+#include <SDL/SDL.h>
+
+#include "../include/AllocCounter.h"
+
+// measured parts of a frame
+enum FramePhase {
+	PHASE_INPUT,
+	PHASE_SIMULATION,
+	PHASE_DRAW,
+	PHASE_TEXT,
+	PHASE_PRESENT,
+	PHASE_CAPTURE, // readback of --capture, nothing without it
+	PHASE_FRAME,
+	PHASE_COUNT
+};
+
+const char* const FRAME_PHASE_NAMES[PHASE_COUNT] = {
+	"input", "simulation", "draw", "text", "present", "capture", "frame"
+};
+
+// recent frames kept for the overlay, also recent input latencies
+const int PROFILER_WINDOW = 256;
+// inputs consumed in one frame waiting for the present
+const int PROFILER_MAX_INPUTS = 64;
+// whole session histogram, 10 microsecond buckets up to 100 ms
+const int PROFILER_BUCKET_US = 10;
+const int PROFILER_BUCKETS = 10000;
+// frames that may still allocate, sprite batches and text lines grow to their size
+const int PROFILER_ALLOC_WARMUP = 120;
+// sizes listed in the allocation report
+const int PROFILER_ALLOC_SIZES = 16;
+
+// percentiles of one phase in milliseconds
+struct PhaseStats
+{
+	int frames;
+	double p50;
+	double p99;
+	double max;
+};
+
+// timestamps every phase of a frame
+class FrameProfiler
+{
+public:
+	FrameProfiler();
+
+	~FrameProfiler();
+
+	void init();
+
+	// frame boundaries
+	void beginFrame();
+	void endFrame();
+
+	// phase boundaries, a phase may be entered several times per frame
+	void begin(FramePhase phase);
+	void end(FramePhase phase);
+
+	// input that changes what the next present shows, time is its performance counter
+	void inputConsumed(Uint64 time);
+
+	// frame is on screen, every consumed input gets its input to present latency
+	void presented();
+
+	// percentiles over the last PROFILER_WINDOW frames
+	PhaseStats getRecentStats(FramePhase phase);
+
+	// percentiles over the whole session
+	PhaseStats getSessionStats(FramePhase phase);
+
+	// input to present latency, the same way as a phase
+	PhaseStats getRecentLatency();
+	PhaseStats getSessionLatency();
+
+	// write session percentiles, one row per phase and one for the latency
+	bool writeCsv(const char* path);
+
+	// count heap allocations per phase, startAllocCounter has to run first.
+	// after the warm-up every allocation is an offender, the debugger may stop at the first
+	void countAllocations(bool breakOnAllocation);
+
+	bool isCountingAllocations();
+
+	// allocations of the last frame and of all frames after the warm-up
+	AllocCount getFrameAllocations();
+	AllocCount getSteadyAllocations();
+
+	// per phase allocations after the warm-up and the most frequent sizes, to stdout
+	void printAllocReport();
+
+private:
+	FrameProfiler(const FrameProfiler&);
+	FrameProfiler& operator=(const FrameProfiler&);
+
+	// add one sample to a histogram row
+	void addSample(int row, float ms);
+
+	// percentiles of count values
+	static PhaseStats recentStats(const float* values, int count);
+
+	// percentiles of a histogram row holding count samples
+	PhaseStats sessionStats(int row, int count, float max);
+
+	double mTicksToMs;
+	Uint64 mFrameStart;
+	Uint64 mPhaseStart[PHASE_COUNT];
+	Uint64 mPhaseTicks[PHASE_COUNT];
+
+	// rolling window
+	float mRecent[PHASE_COUNT][PROFILER_WINDOW];
+	int mRecentCount;
+	int mRecentNext;
+
+	// session histogram, one row per phase and the latency last
+	int* mBuckets;
+	float mSessionMax[PHASE_COUNT];
+	int mSessionFrames;
+
+	// input to present latency
+	Uint64 mPendingInputs[PROFILER_MAX_INPUTS];
+	int mPendingCount;
+	float mLatencies[PROFILER_WINDOW];
+	int mLatencyCount;
+	int mLatencyNext;
+	float mLatencyMax;
+	int mLatencySamples;
+
+	// heap allocations, counted from the warm-up on
+	bool mCountAllocs;
+	bool mBreakOnAlloc;
+	int mAllocWarmup;
+	AllocCount mFrameAllocStart;
+	AllocCount mPhaseAllocStart[PHASE_COUNT];
+	AllocCount mPhaseAllocs[PHASE_COUNT];
+	AllocCount mSteadyAllocs[PHASE_COUNT];
+	int mAllocFrames[PHASE_COUNT];
+	long long mMaxAllocs[PHASE_COUNT];
+	int mSteadyFrames;
+};
+
+FrameProfiler::FrameProfiler() {
+	mTicksToMs = 0;
+	mFrameStart = 0;
+	mRecentCount = 0;
+	mRecentNext = 0;
+	mSessionFrames = 0;
+	memset(mPhaseStart, 0, sizeof(mPhaseStart));
+	memset(mPhaseTicks, 0, sizeof(mPhaseTicks));
+	memset(mRecent, 0, sizeof(mRecent));
+	memset(mSessionMax, 0, sizeof(mSessionMax));
+	mBuckets = new int[(PHASE_COUNT + 1) * PROFILER_BUCKETS];
+	memset(mBuckets, 0, sizeof(int) * (PHASE_COUNT + 1) * PROFILER_BUCKETS);
+	mPendingCount = 0;
+	memset(mLatencies, 0, sizeof(mLatencies));
+	mLatencyCount = 0;
+	mLatencyNext = 0;
+	mLatencyMax = 0;
+	mLatencySamples = 0;
+	mCountAllocs = false;
+	mBreakOnAlloc = false;
+	mAllocWarmup = PROFILER_ALLOC_WARMUP;
+	memset(&mFrameAllocStart, 0, sizeof(mFrameAllocStart));
+	memset(mPhaseAllocStart, 0, sizeof(mPhaseAllocStart));
+	memset(mPhaseAllocs, 0, sizeof(mPhaseAllocs));
+	memset(mSteadyAllocs, 0, sizeof(mSteadyAllocs));
+	memset(mAllocFrames, 0, sizeof(mAllocFrames));
+	memset(mMaxAllocs, 0, sizeof(mMaxAllocs));
+	mSteadyFrames = 0;
+}
+
+FrameProfiler::~FrameProfiler() {
+	delete[] mBuckets;
+}
+
+void FrameProfiler::init() {
+	mTicksToMs = 1000.0 / SDL_GetPerformanceFrequency();
+}
+
+void FrameProfiler::beginFrame() {
+	memset(mPhaseTicks, 0, sizeof(mPhaseTicks));
+	// inputs of a frame that was never presented
+	mPendingCount = 0;
+	if (mCountAllocs) {
+		memset(mPhaseAllocs, 0, sizeof(mPhaseAllocs));
+		mFrameAllocStart = getAllocCount();
+	}
+	mFrameStart = SDL_GetPerformanceCounter();
+}
+
+void FrameProfiler::endFrame() {
+	mPhaseTicks[PHASE_FRAME] = SDL_GetPerformanceCounter() - mFrameStart;
+	for (int i = 0; i < PHASE_COUNT; i++) {
+		float ms = (float)(mPhaseTicks[i] * mTicksToMs);
+		mRecent[i][mRecentNext] = ms;
+		addSample(i, ms);
+		if (ms > mSessionMax[i]) {
+			mSessionMax[i] = ms;
+		}
+	}
+	mRecentNext = (mRecentNext + 1) % PROFILER_WINDOW;
+	if (mRecentCount < PROFILER_WINDOW) {
+		mRecentCount++;
+	}
+	mSessionFrames++;
+	if (mCountAllocs) {
+		AllocCount now = getAllocCount();
+		mPhaseAllocs[PHASE_FRAME].allocations = now.allocations - mFrameAllocStart.allocations;
+		mPhaseAllocs[PHASE_FRAME].bytes = now.bytes - mFrameAllocStart.bytes;
+		if (mAllocWarmup > 0) {
+			// the next frame is the first one that must not allocate
+			if (--mAllocWarmup == 0) {
+				setAllocRecording(true);
+				setAllocBreak(mBreakOnAlloc);
+			}
+		} else {
+			for (int i = 0; i < PHASE_COUNT; i++) {
+				mSteadyAllocs[i].allocations += mPhaseAllocs[i].allocations;
+				mSteadyAllocs[i].bytes += mPhaseAllocs[i].bytes;
+				if (mPhaseAllocs[i].allocations > 0) {
+					mAllocFrames[i]++;
+				}
+				mMaxAllocs[i] = std::max(mMaxAllocs[i], mPhaseAllocs[i].allocations);
+			}
+			mSteadyFrames++;
+		}
+	}
+}
+
+void FrameProfiler::begin(FramePhase phase) {
+	if (mCountAllocs) {
+		mPhaseAllocStart[phase] = getAllocCount();
+	}
+	mPhaseStart[phase] = SDL_GetPerformanceCounter();
+}
+
+void FrameProfiler::end(FramePhase phase) {
+	mPhaseTicks[phase] += SDL_GetPerformanceCounter() - mPhaseStart[phase];
+	if (mCountAllocs) {
+		AllocCount now = getAllocCount();
+		mPhaseAllocs[phase].allocations += now.allocations - mPhaseAllocStart[phase].allocations;
+		mPhaseAllocs[phase].bytes += now.bytes - mPhaseAllocStart[phase].bytes;
+	}
+}
+
+void FrameProfiler::inputConsumed(Uint64 time) {
+	if (mPendingCount < PROFILER_MAX_INPUTS) {
+		mPendingInputs[mPendingCount++] = time;
+	}
+}
+
+void FrameProfiler::presented() {
+	Uint64 now = SDL_GetPerformanceCounter();
+	for (int i = 0; i < mPendingCount; i++) {
+		float ms = now > mPendingInputs[i] ? (float)((now - mPendingInputs[i]) * mTicksToMs) : 0.0f;
+		mLatencies[mLatencyNext] = ms;
+		mLatencyNext = (mLatencyNext + 1) % PROFILER_WINDOW;
+		if (mLatencyCount < PROFILER_WINDOW) {
+			mLatencyCount++;
+		}
+		addSample(PHASE_COUNT, ms);
+		if (ms > mLatencyMax) {
+			mLatencyMax = ms;
+		}
+		mLatencySamples++;
+	}
+	mPendingCount = 0;
+}
+
+PhaseStats FrameProfiler::getRecentStats(FramePhase phase) {
+	return recentStats(mRecent[phase], mRecentCount);
+}
+
+PhaseStats FrameProfiler::getSessionStats(FramePhase phase) {
+	return sessionStats(phase, mSessionFrames, mSessionMax[phase]);
+}
+
+PhaseStats FrameProfiler::getRecentLatency() {
+	return recentStats(mLatencies, mLatencyCount);
+}
+
+PhaseStats FrameProfiler::getSessionLatency() {
+	return sessionStats(PHASE_COUNT, mLatencySamples, mLatencyMax);
+}
+
+void FrameProfiler::addSample(int row, float ms) {
+	int bucket = (int)(ms * 1000.0f / PROFILER_BUCKET_US);
+	if (bucket >= PROFILER_BUCKETS) {
+		bucket = PROFILER_BUCKETS - 1;
+	}
+	mBuckets[row * PROFILER_BUCKETS + bucket]++;
+}
+
+PhaseStats FrameProfiler::recentStats(const float* values, int count) {
+	PhaseStats stats = { count, 0, 0, 0 };
+	if (count == 0) {
+		return stats;
+	}
+	// order statistics on a scratch copy
+	float sorted[PROFILER_WINDOW];
+	memcpy(sorted, values, sizeof(float) * count);
+	int p50 = count / 2;
+	int p99 = count * 99 / 100;
+	std::nth_element(sorted, sorted + p50, sorted + count);
+	stats.p50 = sorted[p50];
+	std::nth_element(sorted, sorted + p99, sorted + count);
+	stats.p99 = sorted[p99];
+	stats.max = *std::max_element(sorted, sorted + count);
+	return stats;
+}
+
+PhaseStats FrameProfiler::sessionStats(int row, int count, float max) {
+	PhaseStats stats = { count, 0, 0, max };
+	if (count == 0) {
+		return stats;
+	}
+	const int* buckets = mBuckets + row * PROFILER_BUCKETS;
+	int p50 = count / 2;
+	int p99 = count * 99 / 100;
+	int seen = 0;
+	bool found50 = false;
+	for (int i = 0; i < PROFILER_BUCKETS; i++) {
+		seen += buckets[i];
+		// report the upper edge of the bucket, never above the real max
+		double ms = std::min((i + 1) * PROFILER_BUCKET_US / 1000.0, stats.max);
+		if (!found50 && seen > p50) {
+			stats.p50 = ms;
+			found50 = true;
+		}
+		if (seen > p99) {
+			stats.p99 = ms;
+			break;
+		}
+	}
+	return stats;
+}
+
+bool FrameProfiler::writeCsv(const char* path) {
+	FILE* file = fopen(path, "w");
+	if (file == NULL) {
+		printf("Unable to write profile %s!\n", path);
+		return false;
+	}
+	fprintf(file, "phase,frames,p50_ms,p99_ms,max_ms\n");
+	for (int i = 0; i < PHASE_COUNT; i++) {
+		PhaseStats stats = getSessionStats((FramePhase)i);
+		fprintf(file, "%s,%d,%.3f,%.3f,%.3f\n", FRAME_PHASE_NAMES[i], stats.frames, stats.p50, stats.p99, stats.max);
+	}
+	// frames here are inputs
+	PhaseStats latency = getSessionLatency();
+	fprintf(file, "input_to_present,%d,%.3f,%.3f,%.3f\n", latency.frames, latency.p50, latency.p99, latency.max);
+	fclose(file);
+	return true;
+}
+
+void FrameProfiler::countAllocations(bool breakOnAllocation) {
+	mCountAllocs = true;
+	mBreakOnAlloc = breakOnAllocation;
+	mAllocWarmup = PROFILER_ALLOC_WARMUP;
+}
+
+bool FrameProfiler::isCountingAllocations() {
+	return mCountAllocs;
+}
+
+AllocCount FrameProfiler::getFrameAllocations() {
+	return mPhaseAllocs[PHASE_FRAME];
+}
+
+AllocCount FrameProfiler::getSteadyAllocations() {
+	return mSteadyAllocs[PHASE_FRAME];
+}
+
+void FrameProfiler::printAllocReport() {
+	if (!mCountAllocs) {
+		return;
+	}
+	printf("heap allocations of %d frames after %d warm-up frames\n", mSteadyFrames, PROFILER_ALLOC_WARMUP);
+	printf("%-10s %10s %12s %14s %10s\n", "phase", "allocating", "allocations", "bytes", "max/frame");
+	// the frame row also holds allocations between the phases
+	for (int i = 0; i < PHASE_COUNT; i++) {
+		printf("%-10s %10d %12lld %14lld %10lld\n", FRAME_PHASE_NAMES[i], mAllocFrames[i],
+			mSteadyAllocs[i].allocations, mSteadyAllocs[i].bytes, mMaxAllocs[i]);
+	}
+	AllocSize sizes[PROFILER_ALLOC_SIZES];
+	int count = getAllocSizes(sizes, PROFILER_ALLOC_SIZES);
+	if (count > 0) {
+		printf("most frequent sizes, --alloc-break stops at the first allocation in a debugger\n");
+	}
+	for (int i = 0; i < count; i++) {
+		printf("  %-10s %8u bytes x %lld\n", ALLOC_SOURCE_NAMES[sizes[i].source], (unsigned int)sizes[i].bytes, sizes[i].count);
+	}
+	if (getUnlistedAllocs() > 0) {
+		printf("  %lld allocations of further sizes\n", getUnlistedAllocs());
+	}
+}
@@ -0,0 +1,174 @@
+//////////////////////////////////////////////////////////////////////////
+// FrameScheduler.h
+//////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstring>
+
+#include <SDL/SDL.h>
+
+#include "../include/Constants.h"
+
+// late parts of recent frames, the slowest sets how early input is read
+const int FRAME_LATCH_WINDOW = 32;
+
+// paces the main loop with the performance counter instead of spinning
+// a frame may also be split for low latency: work that does not depend on
+// input first, then waitForLatch() right before reading input, so the late
+// part ends just before the deadline
+class FrameScheduler
+{
+public:
+	FrameScheduler();
+
+	// frames per second, vsync means present already waits for the display
+	// presentAsap never waits, every frame is presented as soon as it is drawn
+	void init(int framesPerSecond, bool vsync, bool presentAsap = false);
+
+	// block until the next frame is due
+	// static screens sleep until an event arrives or the idle timeout passes
+	void waitForFrame(bool isStatic);
+
+	// low latency frame, block until only the late part of the frame is left
+	void waitForLatch();
+
+	// late part is done, with vsync present returned on the display refresh
+	// only frames that went through waitForLatch move the deadline here,
+	// the others already did in waitForFrame
+	void framePresented();
+
+	// seconds between two frames
+	double getFrameTime();
+
+	// counter ticks to milliseconds
+	double toMilliseconds(Uint64 ticks);
+
+private:
+	// sleep most of the way, spin the last few milliseconds
+	void sleepUntil(Uint64 deadline, bool spin);
+
+	Uint64 mFrequency;
+	Uint64 mPeriod;
+	Uint64 mNextFrame;
+	Uint64 mSpinTicks;
+	bool mVsync;
+	bool mPresentAsap;
+	// late part timing
+	Uint64 mLatchTime;
+	// waitForLatch ran this frame and waitForFrame did not
+	bool mLatched;
+	Uint64 mMarginTicks;
+	Uint64 mLateTicks[FRAME_LATCH_WINDOW];
+	int mLateNext;
+};
+
+FrameScheduler::FrameScheduler() {
+	mFrequency = 1;
+	mPeriod = 0;
+	mNextFrame = 0;
+	mSpinTicks = 0;
+	mVsync = false;
+	mPresentAsap = false;
+	mLatchTime = 0;
+	mLatched = false;
+	mMarginTicks = 0;
+	memset(mLateTicks, 0, sizeof(mLateTicks));
+	mLateNext = 0;
+}
+
+void FrameScheduler::init(int framesPerSecond, bool vsync, bool presentAsap) {
+	mFrequency = SDL_GetPerformanceFrequency();
+	// exact period in counter ticks, no millisecond rounding
+	mPeriod = mFrequency / framesPerSecond;
+	mSpinTicks = mFrequency * FRAME_SPIN_MS / 1000;
+	mMarginTicks = mFrequency * FRAME_LATCH_MARGIN_MS / 1000;
+	mVsync = vsync;
+	mPresentAsap = presentAsap;
+	mNextFrame = SDL_GetPerformanceCounter();
+}
+
+void FrameScheduler::waitForFrame(bool isStatic) {
+	if (isStatic) {
+		// nothing moves, wake up on input, window events or the idle timeout
+		SDL_WaitEventTimeout(NULL, STATIC_WAIT_MS);
+		mNextFrame = SDL_GetPerformanceCounter() + mPeriod;
+		return;
+	}
+
+	if (mPresentAsap) {
+		return;
+	}
+	Uint64 now = SDL_GetPerformanceCounter();
+	// fell more than a frame behind, start again from now instead of catching up
+	if (now > mNextFrame + mPeriod) {
+		mNextFrame = now;
+	}
+	if (now < mNextFrame) {
+		// with vsync present lines the frame up, a coarse sleep is enough
+		sleepUntil(mNextFrame, !mVsync);
+	}
+	mNextFrame += mPeriod;
+}
+
+void FrameScheduler::waitForLatch() {
+	Uint64 now = SDL_GetPerformanceCounter();
+	if (!mPresentAsap) {
+		if (now > mNextFrame + mPeriod) {
+			mNextFrame = now;
+		}
+		// slowest recent late part plus a margin
+		Uint64 budget = 0;
+		for (int i = 0; i < FRAME_LATCH_WINDOW; i++) {
+			budget = mLateTicks[i] > budget ? mLateTicks[i] : budget;
+		}
+		budget += mMarginTicks;
+		if (mNextFrame > budget && now < mNextFrame - budget) {
+			// every millisecond early is latency, always spin the tail
+			sleepUntil(mNextFrame - budget, true);
+		}
+	}
+	mLatchTime = SDL_GetPerformanceCounter();
+	mLatched = true;
+}
+
+void FrameScheduler::framePresented() {
+	if (!mLatched) {
+		return;
+	}
+	mLatched = false;
+	Uint64 now = SDL_GetPerformanceCounter();
+	mLateTicks[mLateNext] = now - mLatchTime;
+	mLateNext = (mLateNext + 1) % FRAME_LATCH_WINDOW;
+	if (mVsync) {
+		// present returned on the refresh, the next one is a period later
+		mNextFrame = now + mPeriod;
+	} else {
+		mNextFrame += mPeriod;
+	}
+}
+
+double FrameScheduler::getFrameTime() {
+	return (double)mPeriod / mFrequency;
+}
+
+double FrameScheduler::toMilliseconds(Uint64 ticks) {
+	return ticks * 1000.0 / mFrequency;
+}
+
+void FrameScheduler::sleepUntil(Uint64 deadline, bool spin) {
+	Uint64 now = SDL_GetPerformanceCounter();
+	Uint64 spinTicks = spin ? mSpinTicks : 0;
+	if (deadline > now + spinTicks) {
+		Uint32 ms = (Uint32)((deadline - now - spinTicks) * 1000 / mFrequency);
+		if (ms > 0) {
+			SDL_Delay(ms);
+		}
+	}
+	if (!spin) {
+		return;
+	}
+	while (SDL_GetPerformanceCounter() < deadline) {
+		// spin tail for the last timer slice
+	}
+}
@@ -0,0 +1,149 @@
+//////////////////////////////////////////////////////////////////////////
+// InputQueue.h
+//////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <SDL/SDL.h>
+
+// what a key means, each state decides what to do with it
+enum InputCommand {
+	INPUT_NONE,
+	INPUT_QUIT, // window closed
+	INPUT_BACK, // escape
+	INPUT_LEAVE, // q on the menu
+	INPUT_START, // g on the menu
+	INPUT_YES,
+	INPUT_NO,
+	INPUT_SERVE,
+	INPUT_LEFT,
+	INPUT_RIGHT,
+	INPUT_PROFILER,
+	INPUT_REWIND
+};
+
+// keyboard layout
+struct KeyBinding
+{
+	SDL_Keycode key;
+	InputCommand command;
+};
+
+const KeyBinding KEY_BINDINGS[] = {
+	{ SDLK_ESCAPE, INPUT_BACK },
+	{ SDLK_q, INPUT_LEAVE },
+	{ SDLK_g, INPUT_START },
+	{ SDLK_y, INPUT_YES },
+	{ SDLK_n, INPUT_NO },
+	{ SDLK_SPACE, INPUT_SERVE },
+	{ SDLK_LEFT, INPUT_LEFT },
+	{ SDLK_RIGHT, INPUT_RIGHT },
+	{ SDLK_F3, INPUT_PROFILER },
+	{ SDLK_r, INPUT_REWIND }
+};
+const int KEY_BINDING_COUNT = sizeof(KEY_BINDINGS) / sizeof(KEY_BINDINGS[0]);
+
+// commands waiting for the current state, far more than one frame brings
+const int INPUT_RING = 64;
+
+// one decoded event
+struct InputEvent
+{
+	InputCommand command;
+	// key went down, false when it was released
+	bool pressed;
+	// performance counter when the event happened
+	Uint64 time;
+};
+
+// decodes SDL events into commands with the time they happened,
+// kept in a fixed ring until the current state reads them
+class InputQueue
+{
+public:
+	InputQueue();
+
+	void init();
+
+	// decode one event, events without a command are ignored
+	void push(const SDL_Event& event);
+
+	// oldest command, false when there is none
+	bool pop(InputEvent* event);
+
+	// forget every waiting command
+	void clear();
+
+	// commands lost because the ring was full
+	int getDropped();
+
+private:
+	Uint64 mFrequency;
+	InputEvent mEvents[INPUT_RING];
+	int mFirst;
+	int mCount;
+	int mDropped;
+};
+
+InputQueue::InputQueue() {
+	mFrequency = 1000;
+	mFirst = 0;
+	mCount = 0;
+	mDropped = 0;
+}
+
+void InputQueue::init() {
+	mFrequency = SDL_GetPerformanceFrequency();
+	clear();
+}
+
+void InputQueue::push(const SDL_Event& event) {
+	InputEvent input;
+	input.command = INPUT_NONE;
+	input.pressed = true;
+	if (event.type == SDL_QUIT) {
+		input.command = INPUT_QUIT;
+	} else if ((event.type == SDL_KEYDOWN || event.type == SDL_KEYUP) && event.key.repeat == 0) {
+		// held keys repeat, only the first press counts
+		for (int i = 0; i < KEY_BINDING_COUNT; i++) {
+			if (KEY_BINDINGS[i].key == event.key.keysym.sym) {
+				input.command = KEY_BINDINGS[i].command;
+			}
+		}
+		input.pressed = event.type == SDL_KEYDOWN;
+	}
+	if (input.command == INPUT_NONE) {
+		return;
+	}
+	if (mCount == INPUT_RING) {
+		mDropped++;
+		return;
+	}
+	// event timestamps are milliseconds of SDL_GetTicks, move them onto the performance counter
+	Uint64 now = SDL_GetPerformanceCounter();
+	Uint32 ticks = SDL_GetTicks();
+	Uint64 age = ticks > event.common.timestamp ? ticks - event.common.timestamp : 0;
+	age = age * mFrequency / 1000;
+	input.time = now > age ? now - age : 0;
+	mEvents[(mFirst + mCount) % INPUT_RING] = input;
+	mCount++;
+}
+
+bool InputQueue::pop(InputEvent* event) {
+	if (mCount == 0) {
+		return false;
+	}
+	*event = mEvents[mFirst];
+	mFirst = (mFirst + 1) % INPUT_RING;
+	mCount--;
+	return true;
+}
+
+void InputQueue::clear() {
+	mFirst = 0;
+	mCount = 0;
+}
+
+int InputQueue::getDropped() {
+	return mDropped;
+}
@@ -0,0 +1,83 @@
+//////////////////////////////////////////////////////////////////////////
+// MultiBall.h
+//////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <vector>
+
+#include "../include/Simulation.h"
+
+// most balls of a world
+const int MULTIBALL_MAX_BALLS = 65536;
+// party balls are smaller than the match ball, so thousands fit on the board, pixels
+const int MULTIBALL_RADIUS = 2;
+// a ball moves at most one radius per tick, two balls cannot pass through each other
+const int MULTIBALL_MAX_VELOCITY = MULTIBALL_RADIUS * SUBPIXELS;
+// grid cell, one ball diameter, balls in cells that are not neighbours cannot touch
+const int MULTIBALL_CELL = 2 * MULTIBALL_RADIUS;
+const int MULTIBALL_COLUMNS = (WINDOW_WIDTH + MULTIBALL_CELL - 1) / MULTIBALL_CELL;
+const int MULTIBALL_ROWS = (WINDOW_HEIGHT + MULTIBALL_CELL - 1) / MULTIBALL_CELL;
+
+// party mode, many extra balls bouncing off the walls, the stickies and each other.
+// balls live in a pool of arrays, and every tick they are sorted into a uniform
+// grid over the board, so only balls in neighbouring cells are tested for contact.
+// balls that leave the board are served again from the middle and score nothing,
+// the match ball of the Simulation does not see them
+class MultiBallWorld
+{
+public:
+	MultiBallWorld();
+
+	// count balls, served from the middle with the seed, the pool is allocated here
+	void reset(int count, unsigned int seed);
+
+	// move every ball one tick and resolve contacts with the stickies of the match
+	void step(const StickyState& player, const StickyState& computer);
+
+	// number of balls
+	int getCount() const;
+
+	// ball arrays, getCount() entries each, subpixels like BallState
+	const int* getBallX() const;
+	const int* getBallY() const;
+
+	// ball pairs that touched in the last step
+	int getContacts() const;
+
+private:
+	// move, bounce off side walls, serve again what left the board
+	void moveBalls();
+
+	// sort the pool by grid cell, a counting sort
+	void buildGrid();
+
+	// resolve pairs within a cell and with the cells right and below
+	void collideBalls();
+	void collidePair(int a, int b);
+
+	// balls in the cells around the sticky
+	void collideSticky(const StickyState& sticky);
+
+	// serve ball i from the middle
+	void serve(int i);
+
+	int mCount;
+	unsigned int mSeed;
+	int mContacts;
+
+	// pool
+	std::vector<int> mX;
+	std::vector<int> mY;
+	std::vector<int> mVelX;
+	std::vector<int> mVelY;
+
+	// grid, the pool is kept sorted by cell, balls of cell c are mCellStart[c] to mCellStart[c + 1] - 1
+	std::vector<int> mCellStart;
+	std::vector<int> mBallCell;
+	// pool in cell order while sorting
+	std::vector<int> mSortedX;
+	std::vector<int> mSortedY;
+	std::vector<int> mSortedVelX;
+	std::vector<int> mSortedVelY;
+};
@@ -0,0 +1,93 @@
+//////////////////////////////////////////////////////////////////////////
+// NetPeer.h
+//////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "../include/NetSocket.h"
+#include "../include/Rollback.h"
+
+// packet layout, all numbers little endian
+// "PNET" magic, u8 type, u32 session
+// hello: nothing more, the joining player picks the session
+// input: u32 ack, u32 tick, s16 advantage, u32 first, u8 count, count inputs packed by encodeInput
+// every input packet repeats all inputs the other side has not confirmed,
+// so a lost packet costs nothing but a later correction
+const char NET_MAGIC[4] = { 'P', 'N', 'E', 'T' };
+const int NET_HEADER_SIZE = 9;
+const int NET_INPUT_HEADER_SIZE = NET_HEADER_SIZE + 15;
+const int NET_MAX_INPUTS = ROLLBACK_MAX_PREDICTION;
+const int NET_MAX_PACKET = NET_INPUT_HEADER_SIZE + NET_MAX_INPUTS;
+const int NET_DEFAULT_PORT = 27960;
+const int NET_HELLO_INTERVAL_MS = 250; // joining player asks this often
+const int NET_TIMEOUT_MS = 5000; // peer is gone after this long without a packet
+const int NET_FINAL_SENDS = 5; // last inputs are repeated when the game ends
+const int NET_DELAY_SLOTS = 256; // received packets held back by the simulated delay
+
+enum NetPacketType {
+	NET_HELLO = 1,
+	NET_INPUT = 2
+};
+
+// one side of a two player game over udp
+// the host plays the bottom sticky, the joining player the top one
+class NetPeer
+{
+public:
+	NetPeer();
+
+	// wait for a player on port
+	bool host(int port);
+
+	// connect to the player hosting on name:port
+	bool join(const char* name, int port, unsigned int session);
+
+	void close();
+
+	// hold received packets back, simulates a slow network on loopback
+	void setDelay(int ms);
+
+	// handshake, true once the other player is there
+	bool connect(unsigned int now);
+
+	// read every waiting packet into the session, false once the other player went silent
+	bool receive(unsigned int now, RollbackSession* session);
+
+	// send the local inputs the other player has not confirmed
+	void send(RollbackSession* session);
+
+	bool isOpen();
+	bool isConnected();
+
+	// sticky of the local player
+	StickySide getLocalSide();
+
+private:
+	// one packet waiting for the simulated delay
+	struct DelayedPacket
+	{
+		unsigned int due;
+		int size;
+		unsigned char data[NET_MAX_PACKET];
+	};
+
+	// hello with the session
+	void sendHello();
+
+	// handle one packet, false when it is not from the other player
+	bool readPacket(const unsigned char* data, int size, RollbackSession* session);
+
+	UdpSocket mSocket;
+	NetAddress mPeer;
+	bool mHost;
+	bool mConnected;
+	unsigned int mSession;
+	unsigned int mLastHello;
+	bool mLastHelloSent;
+	unsigned int mLastReceived;
+	int mDelay;
+	// ring of delayed packets
+	DelayedPacket mDelayed[NET_DELAY_SLOTS];
+	int mDelayedFirst;
+	int mDelayedCount;
+};
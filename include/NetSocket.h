@@ -0,0 +1,48 @@
+//////////////////////////////////////////////////////////////////////////
+// NetSocket.h
+//////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+
+// ipv4 address of a peer, host in host byte order
+struct NetAddress
+{
+	unsigned int host;
+	unsigned short port;
+};
+
+// look a host name or dotted address up
+bool resolveAddress(const char* name, int port, NetAddress* address);
+
+bool operator==(const NetAddress& a, const NetAddress& b);
+
+// non blocking udp socket
+class UdpSocket
+{
+public:
+	UdpSocket();
+
+	// closes socket
+	~UdpSocket();
+
+	// bind to port, 0 picks any free port
+	bool open(int port);
+	void close();
+
+	// send one datagram
+	bool send(const NetAddress& to, const void* data, int size);
+
+	// read one datagram, returns its size, 0 when nothing is waiting and -1 on error
+	int receive(NetAddress* from, void* data, int size);
+
+	bool isOpen();
+
+private:
+	UdpSocket(const UdpSocket&);
+	UdpSocket& operator=(const UdpSocket&);
+
+	// SOCKET on windows, file descriptor elsewhere
+	ptrdiff_t mSocket;
+};
@@ -0,0 +1,91 @@
+//////////////////////////////////////////////////////////////////////////
+// Policy.h
+//////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "../include/Simulation.h"
+
+// which sticky a policy controls
+enum StickySide {
+	SIDE_PLAYER,
+	SIDE_COMPUTER
+};
+
+// paddle policy, looks at the state and returns a direction for its sticky,
+// -1 left, 0 stop, 1 right. plain functions with no state so any number of
+// matches can share them from different threads
+typedef int (*PaddlePolicy)(const SimState& state, StickySide side);
+
+// named entry of the policy zoo
+struct PolicyEntry
+{
+	const char* name;
+	PaddlePolicy policy;
+};
+
+// built in policies
+// tracker: the classic computer, follows the ball only while it comes closer
+int trackerPolicy(const SimState& state, StickySide side);
+// follower: follows the ball all the time
+int followerPolicy(const SimState& state, StickySide side);
+// keeper: follows the ball while it comes closer, goes back to the middle otherwise
+int keeperPolicy(const SimState& state, StickySide side);
+// lazy: like tracker but waits until the ball crossed the middle line
+int lazyPolicy(const SimState& state, StickySide side);
+
+// predictor: works out where the ball crosses its line and moves there
+int predictorEasyPolicy(const SimState& state, StickySide side);
+int predictorNormalPolicy(const SimState& state, StickySide side);
+int predictorHardPolicy(const SimState& state, StickySide side);
+
+// every built in policy
+const PolicyEntry POLICIES[] = {
+	{ "tracker", trackerPolicy },
+	{ "follower", followerPolicy },
+	{ "keeper", keeperPolicy },
+	{ "lazy", lazyPolicy },
+	{ "predictor-easy", predictorEasyPolicy },
+	{ "predictor-normal", predictorNormalPolicy },
+	{ "predictor-hard", predictorHardPolicy }
+};
+const int POLICY_COUNT = sizeof(POLICIES) / sizeof(POLICIES[0]);
+
+// how well the predictor plays
+struct PredictorSkill
+{
+	// ticks after the other sticky hit the ball before it starts moving
+	int reactionTicks;
+	// aim is off by up to this many subpixels, same for one flight of the ball
+	int error;
+	// ticks the sticky moves into the ball before it lands, 0 stands still and only defends
+	int swingTicks;
+};
+
+// predictor skill of each ComputerSkill, classic does not use it
+const PredictorSkill PREDICTOR_SKILLS[] = {
+	{ 0, 0, 0 },
+	{ TICKS_PER_SECOND / 2, 40 * SUBPIXELS, 0 },
+	{ TICKS_PER_SECOND / 3, 24 * SUBPIXELS, 16 },
+	{ 0, 0, 40 }
+};
+
+// command line names of each ComputerSkill
+const char* const SKILL_NAMES[] = { "classic", "easy", "normal", "hard" };
+const int SKILL_COUNT = sizeof(SKILL_NAMES) / sizeof(SKILL_NAMES[0]);
+
+// ball center x when it gets to y, reflections off the side walls folded in.
+// closed form, the walls mirror the straight line so it is folded back into
+// the area, the cost does not depend on how far away y is
+int predictBallX(const BallState& ball, int y);
+
+// predictor direction for a sticky, plain function of the state
+int predictorDirection(const SimState& state, StickySide side, const PredictorSkill& skill);
+
+// look a policy up by name, NULL if there is none
+const PolicyEntry* findPolicy(const char* name);
+
+// play one match between two policies, seed changes the serve direction.
+// a rally longer than maxRallyTicks is served again, 0 lets it run
+MatchStats playPolicyMatch(Simulation& sim, PaddlePolicy player, PaddlePolicy computer,
+	unsigned int seed, long long maxTicks = MAX_MATCH_TICKS, long long maxRallyTicks = 0);
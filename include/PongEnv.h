@@ -0,0 +1,66 @@
+//////////////////////////////////////////////////////////////////////////
+// PongEnv.h
+//////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+// C interface of the PongEnv shared library, K matches stepped together
+// for training agents. the caller owns every buffer, the library writes
+// observations, rewards and done flags straight into them and never
+// allocates after pong_env_create.
+// the agent plays the bottom sticky against the classic computer
+
+#if defined(_WIN32)
+#	if defined(PONG_ENV_BUILD)
+#		define PONG_ENV_API __declspec(dllexport)
+#	else
+#		define PONG_ENV_API __declspec(dllimport)
+#	endif
+#else
+#	define PONG_ENV_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// floats per match in the observation buffer
+// ball x, ball y, ball velocity x, ball velocity y, player x, computer x
+// positions are 0..1 of the window, velocities -1..1 of the fastest ball
+#define PONG_ENV_OBSERVATION_SIZE 6
+
+typedef struct PongEnv PongEnv;
+
+// count matches, match i serves with seed + i, every step runs ticksPerStep
+// simulation ticks with the same action, NULL when count or ticksPerStep is not positive
+PONG_ENV_API PongEnv* pong_env_create(int count, unsigned int seed, int ticksPerStep);
+
+PONG_ENV_API void pong_env_destroy(PongEnv* env);
+
+// number of matches
+PONG_ENV_API int pong_env_count(const PongEnv* env);
+
+// buffers reset and step write to, kept until set again
+// observations: count * PONG_ENV_OBSERVATION_SIZE floats, match after match
+// rewards: count floats, +1 for every point of the agent, -1 for every point of the computer
+// dones: count bytes, 1 when a match reached SCORE and started over
+// any of them may be NULL when it is not needed
+PONG_ENV_API void pong_env_set_buffers(PongEnv* env, float* observations, float* rewards, unsigned char* dones);
+
+// pixel observations as well, drawn by a software renderer without window
+// pixels: count * stack * height * width * channels bytes, match after match,
+// the stack frames of a match oldest first, rows packed, channels 1 gray or 3 rgb
+// NULL pixels turns them off, returns 0 when the size or channels are not supported
+PONG_ENV_API int pong_env_set_pixels(PongEnv* env, unsigned char* pixels, int width, int height, int channels, int stack);
+
+// start every match over and write the first observations
+PONG_ENV_API void pong_env_reset(PongEnv* env);
+
+// actions: count sticky directions, -1 left, 0 stop, 1 right
+// finished matches start over, the observation is then the one of the new match
+// and the pixel stack starts over with it
+PONG_ENV_API void pong_env_step(PongEnv* env, const int* actions);
+
+#ifdef __cplusplus
+}
+#endif
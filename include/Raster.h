@@ -0,0 +1,81 @@
+//////////////////////////////////////////////////////////////////////////
+// Raster.h
+//////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "../include/Simulation.h"
+
+class BatchWorld;
+
+// bytes per pixel of a frame
+enum RasterFormat {
+	RASTER_GRAY = 1,
+	RASTER_RGB = 3
+};
+
+// colors, rgb, gray frames use the luma
+const unsigned int RASTER_BOARD_COLOR = 0x808080; // line under the score band
+const unsigned int RASTER_COMPUTER_COLOR = 0xE04040;
+const unsigned int RASTER_PLAYER_COLOR = 0x4080E0;
+const unsigned int RASTER_BALL_COLOR = 0xFFFFFF;
+const unsigned int RASTER_SCORE_COLOR = 0xC0C0C0; // one pip per point in the score band
+// longest frame row, in pixels
+const int RASTER_MAX_WIDTH = 4096;
+// pattern bytes written at once, a whole number of rgb pixels and vector registers
+const int RASTER_CHUNK = 48;
+
+// software renderer of the board without window or gpu, for pixel observations.
+// the window is scaled to any frame size, every shape is a list of row spans,
+// and spans are filled by fixed size copies of a prepared color pattern,
+// which the compiler turns into vector stores
+class Rasterizer
+{
+public:
+	// width and height of the frame in pixels, false from isValid when out of range
+	Rasterizer(int width, int height, RasterFormat format);
+
+	bool isValid();
+
+	// bytes of one frame, rows are packed
+	int getFrameSize();
+
+	// draw one state into frame
+	void draw(const SimState& state, unsigned char* frame);
+
+	// draw every match of the world, match i goes to frames + i * stride
+	void drawBatch(const BatchWorld& world, unsigned char* frames, int stride);
+
+private:
+	// color patterns of the board elements
+	enum Pattern {
+		PATTERN_BOARD,
+		PATTERN_COMPUTER,
+		PATTERN_PLAYER,
+		PATTERN_BALL,
+		PATTERN_SCORE,
+		PATTERN_COUNT
+	};
+
+	// whole board, positions in subpixels
+	void drawBoard(int ballX, int ballY, int radius, int computerX, int computerY,
+		int playerX, int playerY, int playerScore, int computerScore, unsigned char* frame);
+
+	// rectangle in subpixels, at least one pixel big so nothing vanishes when scaled down
+	void fillRect(int left, int top, int right, int bottom, Pattern pattern, unsigned char* frame);
+
+	// circle in subpixels, same rule
+	void fillCircle(int x, int y, int radius, Pattern pattern, unsigned char* frame);
+
+	// pixels [from, to) of a row
+	void fillSpan(unsigned char* row, int from, int to, Pattern pattern);
+
+	int mWidth;
+	int mHeight;
+	int mFormat;
+	// frame pixels per subpixel
+	float mScaleX;
+	float mScaleY;
+	// RASTER_CHUNK bytes of each color, the last partial chunk copies a prefix
+	unsigned char mPatterns[PATTERN_COUNT][RASTER_CHUNK];
+};
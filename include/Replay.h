@@ -0,0 +1,94 @@
+//////////////////////////////////////////////////////////////////////////
+// Replay.h
+//////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "../include/Simulation.h"
+
+// file layout, all numbers little endian
+// "PRPL" magic, u16 version, u32 seed, u8 computer skill, u32 ticks, u32 runs
+// then runs of (u8 input, u8 length), input bits: 0 left, 1 right, 2 serve
+// one input per simulation tick, TICKS_PER_SECOND of them per second
+const char REPLAY_MAGIC[4] = { 'P', 'R', 'P', 'L' };
+const int REPLAY_VERSION = 4;
+const int REPLAY_HEADER_SIZE = 19;
+const int REPLAY_MAX_RUN = 255;
+// runs reserved when recording starts, the game does not allocate while it records minutes of play
+const int REPLAY_RESERVED_RUNS = 16384;
+
+// pack input into one byte and back
+unsigned char encodeInput(const TickInput& input);
+TickInput decodeInput(unsigned char code);
+
+// collects per tick input, run length encoded
+class ReplayRecorder
+{
+public:
+	ReplayRecorder();
+
+	// start a new recording against a computer of skill
+	void begin(unsigned int seed, ComputerSkill skill = SKILL_CLASSIC);
+
+	// append input of one tick
+	void record(const TickInput& input);
+
+	// forget the input of every tick from ticks on, the game was rewound
+	void truncate(unsigned int ticks);
+
+	// write to file
+	bool save(std::string path);
+
+	unsigned int getTickCount();
+
+private:
+	unsigned int mSeed;
+	ComputerSkill mSkill;
+	unsigned int mTicks;
+	std::vector<unsigned char> mRuns;
+};
+
+// feeds a recording back one tick at a time
+class ReplayPlayer
+{
+public:
+	ReplayPlayer();
+
+	// read file, false on bad or truncated data
+	bool load(std::string path);
+
+	// input of the next tick, false at the end
+	bool next(TickInput* input);
+
+	// start from the first tick again
+	void rewind();
+
+	unsigned int getSeed();
+	ComputerSkill getSkill();
+	unsigned int getTickCount();
+
+private:
+	unsigned int mSeed;
+	ComputerSkill mSkill;
+	unsigned int mTicks;
+	std::vector<unsigned char> mRuns;
+	// read cursor
+	size_t mRun;
+	int mLeft;
+};
+
+// result of playing a recording without a window
+struct ReplayStats
+{
+	long long ticks;
+	int playerWins;
+	int computerWins;
+	int playerScore;
+	int computerScore;
+};
+
+// run the recording through the game logic as fast as possible
+ReplayStats playReplay(Simulation& sim, ReplayPlayer& replay);
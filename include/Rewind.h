@@ -0,0 +1,48 @@
+//////////////////////////////////////////////////////////////////////////
+// Rewind.h
+//////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "../include/Simulation.h"
+
+// seconds of play kept for rewinding
+const int REWIND_SECONDS = 5;
+const int REWIND_TICKS = REWIND_SECONDS * TICKS_PER_SECOND;
+// ticks stepped back per tick while rewinding
+const int REWIND_SPEED = 2;
+
+// everything a single player game needs to go back to a tick
+// plain data, a copy is the whole capture
+struct GameSnapshot
+{
+	// state before the tick
+	SimState state;
+	// ticks played before, also the number of recorded inputs
+	unsigned int tick;
+};
+
+// the last REWIND_TICKS snapshots, allocated once with the ring
+// pushing never allocates, the oldest snapshot is overwritten when full
+class SnapshotRing
+{
+public:
+	SnapshotRing();
+
+	// forget every snapshot
+	void clear();
+
+	// keep a snapshot as the newest
+	void push(const GameSnapshot& snapshot);
+
+	// take the newest snapshot back out, false when there is none
+	bool pop(GameSnapshot* snapshot);
+
+	int getCount();
+
+private:
+	GameSnapshot mSnapshots[REWIND_TICKS];
+	// slot the next push goes to
+	int mNext;
+	int mCount;
+};
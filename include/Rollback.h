@@ -0,0 +1,117 @@
+//////////////////////////////////////////////////////////////////////////
+// Rollback.h
+//////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "../include/Simulation.h"
+#include "../include/Policy.h"
+
+// ticks of snapshots and inputs kept, power of two
+const int ROLLBACK_RING = 128;
+// ticks the game may run ahead of the last confirmed remote input, 200 ms at 240 Hz
+const int ROLLBACK_MAX_PREDICTION = 48;
+// ticks between two time sync pauses
+const int ROLLBACK_SYNC_INTERVAL = 8;
+
+// two player game where the remote input arrives late.
+// every tick is simulated at once with the local input and a guess of the
+// remote input, the state before each tick is kept, and ticks are simulated
+// again from the first wrong guess once the real input is there.
+// a tick costs one SimState copy and one Simulation step, so many of them
+// fit into a frame
+class RollbackSession
+{
+public:
+	RollbackSession();
+
+	// start a match at tick 0, local input drives the sticky of localSide
+	void begin(StickySide localSide);
+
+	// false while the game is too far ahead of the remote input, try again next tick
+	bool canAdvance();
+
+	// simulate the next tick with local input and the guessed remote input
+	void advance(const TickInput& local);
+
+	// input of the remote player for a tick, ticks already known are ignored
+	void addRemoteInput(unsigned int tick, const TickInput& input);
+
+	// simulate again from the first wrong guess, returns the number of ticks simulated again
+	int resimulate();
+
+	// remote player has every local input before tick
+	void setLocalAck(unsigned int tick);
+
+	// time sync, remote player is at tick and advantage ticks ahead of us
+	void setRemoteTick(unsigned int tick, int advantage);
+
+	// running ahead of the remote player, skip a tick so it can catch up
+	bool shouldWait();
+
+	// win of a tick both players agree on, TICK_NONE until there is one
+	TickResult pollConfirmedResult();
+
+	// next tick to simulate
+	unsigned int getTick();
+
+	// remote input is known for every tick before this one
+	unsigned int getConfirmedTick();
+
+	unsigned int getLocalAck();
+
+	// local ticks ahead of the remote player, sent to it for time sync
+	int getAdvantage();
+
+	// local input of a tick that is still kept
+	TickInput getLocalInput(unsigned int tick);
+
+	StickySide getLocalSide();
+
+	// current state and the state before the latest tick
+	const SimState& getState();
+	const SimState& getPreviousState();
+
+	// resimulations so far and the longest one in ticks
+	int getRollbackCount();
+	int getMaxRollback();
+
+private:
+	// remote input of a tick, the real one when known, otherwise the last known direction
+	unsigned char remoteInput(unsigned int tick);
+
+	// simulate one tick from the current state
+	void simulate(unsigned int tick);
+
+	Simulation mSim;
+	StickySide mLocalSide;
+	unsigned int mTick;
+	unsigned int mConfirmed;
+	// remote input of tick mConfirmed - 1, the guess for later ticks.
+	// kept apart from the ring, whose slot is taken by tick mConfirmed + ROLLBACK_RING - 1
+	unsigned char mLastRemoteInput;
+	unsigned int mLocalAck;
+	// ticks before this one were checked for a win
+	unsigned int mReported;
+	// first tick to simulate again
+	unsigned int mRollbackFrom;
+	// time sync, newest tick the remote player reported
+	unsigned int mRemoteTick;
+	int mLocalAdvantage;
+	int mRemoteAdvantage;
+	int mSyncWait;
+	// statistics
+	int mRollbackCount;
+	int mMaxRollback;
+
+	// per tick rings, slot is tick % ROLLBACK_RING, inputs packed by encodeInput
+	// state before the tick
+	SimState mSnapshots[ROLLBACK_RING];
+	unsigned char mLocalInputs[ROLLBACK_RING];
+	unsigned char mRemoteInputs[ROLLBACK_RING];
+	// tick a remote slot holds, tells real input from an old slot
+	unsigned int mRemoteTicks[ROLLBACK_RING];
+	// remote input the tick was simulated with
+	unsigned char mUsedInputs[ROLLBACK_RING];
+	unsigned char mResults[ROLLBACK_RING];
+};
@@ -0,0 +1,108 @@
+//////////////////////////////////////////////////////////////////////////
+// ScreenCache.h
+//////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstdio>
+
+#include <SDL/SDL.h>
+
+// retained frame for screens that do not change on their own
+// the screen is drawn once into a target texture and presented only when
+// it is new or the window needs it again, e.g. after being uncovered
+class ScreenCache
+{
+public:
+	ScreenCache();
+
+	// deallocates memory
+	~ScreenCache();
+
+	// create the target, without target support screens are redrawn directly
+	void init(SDL_Renderer* renderer, int width, int height);
+
+	// deallocates target
+	void freeCache();
+
+	// show the screen drawn by draw, which is only called when the cache holds another screen
+	// returns false when nothing had to be presented
+	bool show(SDL_Renderer* renderer, void (*draw)());
+
+	// window was exposed or restored, present again on next show
+	void invalidate();
+
+	// target contents were lost, draw again on next show
+	void reset();
+
+private:
+	SDL_Texture* mTarget;
+	// draw function of the screen held in the target
+	void (*mOwner)();
+	// window shows what the target holds
+	bool mPresented;
+};
+
+ScreenCache::ScreenCache() {
+	mTarget = NULL;
+	mOwner = NULL;
+	mPresented = false;
+}
+
+ScreenCache::~ScreenCache() {
+	freeCache();
+}
+
+void ScreenCache::init(SDL_Renderer* renderer, int width, int height) {
+	freeCache();
+	if (SDL_RenderTargetSupported(renderer)) {
+		mTarget = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, width, height);
+		if (mTarget == NULL) {
+			printf("Unable to create screen cache! SDL Error: %s\n", SDL_GetError());
+		}
+	}
+}
+
+void ScreenCache::freeCache() {
+	if (mTarget != NULL) {
+		SDL_DestroyTexture(mTarget);
+		mTarget = NULL;
+	}
+	mOwner = NULL;
+	mPresented = false;
+}
+
+bool ScreenCache::show(SDL_Renderer* renderer, void (*draw)()) {
+	if (draw == mOwner && mPresented) {
+		return false;
+	}
+
+	if (mTarget == NULL) {
+		// no target, draw straight to the window but still only on change
+		SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0xFF);
+		SDL_RenderClear(renderer);
+		draw();
+	} else {
+		if (draw != mOwner) {
+			SDL_SetRenderTarget(renderer, mTarget);
+			SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0xFF);
+			SDL_RenderClear(renderer);
+			draw();
+			SDL_SetRenderTarget(renderer, NULL);
+		}
+		SDL_RenderCopy(renderer, mTarget, NULL, NULL);
+	}
+	SDL_RenderPresent(renderer);
+	mOwner = draw;
+	mPresented = true;
+	return true;
+}
+
+void ScreenCache::invalidate() {
+	mPresented = false;
+}
+
+void ScreenCache::reset() {
+	mOwner = NULL;
+	mPresented = false;
+}
@@ -0,0 +1,153 @@
+//////////////////////////////////////////////////////////////////////////
+// Simulation.h
+//////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "../include/Constants.h"
+
+// ball state, plain data
+// positions and dimensions are subpixels, velocities subpixels per tick
+struct BallState
+{
+	// center position
+	int centerX;
+	int centerY;
+	// velocity
+	int velocityX;
+	int velocityY;
+	// dimension
+	int radius;
+};
+
+// sticky state, plain data, same units as BallState
+struct StickyState
+{
+	// start position
+	int startX;
+	int startY;
+	// velocity
+	int velocityX;
+	int velocityY;
+	// dimension
+	int width;
+	int height;
+};
+
+// whole game state, can be copied freely
+struct SimState
+{
+	BallState ball;
+	StickyState computer;
+	StickyState player;
+	int playerScore;
+	int computerScore;
+	int ballSpeed;
+	bool start;
+};
+
+// player input for one tick
+struct TickInput
+{
+	// sticky direction, -1 left, 0 stop, 1 right
+	int direction;
+	// launch the ball
+	bool serve;
+};
+
+// how the computer sticky plays in step()
+// classic follows the ball, the others predict where it lands, see Policy.h
+enum ComputerSkill {
+	SKILL_CLASSIC,
+	SKILL_EASY,
+	SKILL_NORMAL,
+	SKILL_HARD
+};
+
+// what happened in one tick
+enum TickResult {
+	TICK_NONE,
+	TICK_PLAYER_SCORE,
+	TICK_COMPUTER_SCORE,
+	TICK_PLAYER_WIN,
+	TICK_COMPUTER_WIN
+};
+
+// headless game logic, no window, renderer or timer
+class Simulation
+{
+public:
+	Simulation();
+
+	// reset ball, stickies and score
+	void reset();
+
+	// reset score only, stickies stay where they are
+	void resetScore();
+
+	// ball back to the middle waiting for a serve, score stays
+	void resetBall();
+
+	// launch the ball if it is waiting, velX in subpixels per tick
+	void serve(int velX = 0);
+
+	// set player sticky velocity
+	void setPlayerVelocity(int velX);
+
+	// set computer sticky velocity, for matches where step() is not used
+	void setComputerVelocity(int velX);
+
+	// apply one tick of player input
+	void applyInput(const TickInput& input);
+
+	// apply one tick of input for both stickies, two player games
+	void applyInputs(const TickInput& player, const TickInput& computer);
+
+	// computer controls player sticky, mirror of changeComputerStickySpeed
+	void changePlayerStickySpeed();
+
+	// computer controls computer sticky, the way the skill says
+	void changeComputerStickySpeed();
+
+	// skill of the computer sticky, kept by reset()
+	void setComputerSkill(ComputerSkill skill);
+	ComputerSkill getComputerSkill() const;
+
+	// score, then sweep the ball through the tick bouncing off walls and stickies
+	TickResult changeBallSpeed();
+
+	// advance one tick, computer sticky follows changeComputerStickySpeed
+	TickResult step();
+
+	// advance one tick, both stickies keep the velocity they were given
+	TickResult advance();
+
+	// state access
+	SimState& getState();
+	const SimState& getState() const;
+
+private:
+	SimState mState;
+	ComputerSkill mComputerSkill;
+};
+
+// collision helpers, test position after next move
+bool checkWallCollision(const StickyState& sticky);
+bool checkWallCollision(const BallState& ball);
+bool checkEntityCollision(const StickyState& sticky, const BallState& ball);
+
+// match summary
+struct MatchStats
+{
+	int playerScore;
+	int computerScore;
+	long long ticks;
+	// rallies cut off by a rally tick limit and served again
+	int stalledRallies;
+};
+
+// horizontal serve velocity from the match random state, an lcg so matches stay reproducible
+int nextServeVelocity(unsigned int* seed);
+
+// play one computer vs computer match, seed changes the serve direction
+MatchStats playMatch(Simulation& sim, unsigned int seed, long long maxTicks = MAX_MATCH_TICKS);
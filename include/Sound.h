@@ -0,0 +1,314 @@
+//////////////////////////////////////////////////////////////////////////
+// Sound.h
+//////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <vector>
+#include <atomic>
+#include <algorithm>
+
+#include <SDL/SDL.h>
+
+// output rate asked for, the device may pick another one and the effects follow it
+const int SOUND_FREQUENCY = 48000;
+// samples per callback, about 5 ms at 48 kHz, a hit is heard at most one buffer late
+const int SOUND_BUFFER_SAMPLES = 256;
+// effects sounding at once, the oldest one makes room for a new one
+const int SOUND_VOICES = 8;
+// play commands waiting for the callback, a power of two
+const int SOUND_QUEUE = 64;
+
+// effects of the game
+enum SoundEffect {
+	SOUND_HIT, // ball off a sticky
+	SOUND_WALL, // ball off a side wall
+	SOUND_SCORE, // ball left the board
+	SOUND_COUNT
+};
+
+// what the game asks the audio thread to do
+struct SoundCommand
+{
+	SoundEffect effect;
+	// 0 to 256
+	int volume;
+};
+
+// single producer, single consumer ring, the game thread pushes and the
+// audio callback pops, neither of them locks or allocates
+class SoundQueue
+{
+public:
+	SoundQueue();
+
+	// game thread, false when the ring is full
+	bool push(const SoundCommand& command);
+
+	// audio thread, false when there is nothing to do
+	bool pop(SoundCommand* command);
+
+private:
+	SoundCommand mCommands[SOUND_QUEUE];
+	// positions only grow, the difference is the fill
+	std::atomic<unsigned int> mWrite;
+	std::atomic<unsigned int> mRead;
+};
+
+// sound effects on an SDL audio device.
+// every effect is synthesized into 16 bit pcm when the device opens, the
+// callback only drains the command queue and adds voices into the buffer
+class SoundMixer
+{
+public:
+	SoundMixer();
+
+	// closes the device
+	~SoundMixer();
+
+	// open the default device and build the effects, false leaves the game silent
+	bool open();
+
+	// stop the callback and free the effects
+	void close();
+
+	// queue an effect, nothing happens without a device
+	void play(SoundEffect effect, int volume = 256);
+
+	// effects queued and effects lost because the queue was full
+	int getPlayed();
+	int getDropped();
+
+	// longest callback so far in ms, and the time one buffer plays
+	double getMaxMixMs();
+	double getBufferMs();
+
+private:
+	SoundMixer(const SoundMixer&);
+	SoundMixer& operator=(const SoundMixer&);
+
+	// pcm of every effect at the device rate
+	void synthesize();
+
+	// a tone sliding from one frequency to another, fading out
+	void tone(SoundEffect effect, double fromHz, double toHz, double ms, bool square);
+
+	// audio thread
+	static void SDLCALL callback(void* userdata, Uint8* stream, int length);
+	void mix(Sint16* out, int samples);
+
+	SDL_AudioDeviceID mDevice;
+	int mFrequency;
+	int mBufferSamples;
+	std::vector<Sint16> mEffects[SOUND_COUNT];
+	SoundQueue mQueue;
+	int mPlayed;
+	int mDropped;
+
+	// audio thread only
+	struct Voice
+	{
+		const Sint16* samples;
+		int length;
+		int position;
+		int volume;
+	};
+	Voice mVoices[SOUND_VOICES];
+	Uint64 mFrequencyTicks;
+	// longest mix in performance counter ticks, written by the audio thread
+	std::atomic<Uint64> mMaxMixTicks;
+};
+
+SoundQueue::SoundQueue() : mWrite(0), mRead(0) {
+	memset(mCommands, 0, sizeof(mCommands));
+}
+
+bool SoundQueue::push(const SoundCommand& command) {
+	unsigned int write = mWrite.load(std::memory_order_relaxed);
+	if (write - mRead.load(std::memory_order_acquire) == SOUND_QUEUE) {
+		return false;
+	}
+	mCommands[write % SOUND_QUEUE] = command;
+	// the command is written before the callback can see it
+	mWrite.store(write + 1, std::memory_order_release);
+	return true;
+}
+
+bool SoundQueue::pop(SoundCommand* command) {
+	unsigned int read = mRead.load(std::memory_order_relaxed);
+	if (read == mWrite.load(std::memory_order_acquire)) {
+		return false;
+	}
+	*command = mCommands[read % SOUND_QUEUE];
+	// the slot may be written again only after it was read
+	mRead.store(read + 1, std::memory_order_release);
+	return true;
+}
+
+SoundMixer::SoundMixer() : mMaxMixTicks(0) {
+	mDevice = 0;
+	mFrequency = SOUND_FREQUENCY;
+	mBufferSamples = SOUND_BUFFER_SAMPLES;
+	mPlayed = 0;
+	mDropped = 0;
+	memset(mVoices, 0, sizeof(mVoices));
+	mFrequencyTicks = 1;
+}
+
+SoundMixer::~SoundMixer() {
+	close();
+}
+
+bool SoundMixer::open() {
+	close();
+	if (SDL_InitSubSystem(SDL_INIT_AUDIO) < 0) {
+		printf("Unable to initialize audio! SDL Error: %s\n", SDL_GetError());
+		return false;
+	}
+	SDL_AudioSpec want;
+	SDL_AudioSpec have;
+	memset(&want, 0, sizeof(want));
+	want.freq = SOUND_FREQUENCY;
+	want.format = AUDIO_S16SYS;
+	want.channels = 1;
+	want.samples = SOUND_BUFFER_SAMPLES;
+	want.callback = callback;
+	want.userdata = this;
+	// format and channels are converted by SDL, the rate is taken as it comes
+	mDevice = SDL_OpenAudioDevice(NULL, 0, &want, &have, SDL_AUDIO_ALLOW_FREQUENCY_CHANGE | SDL_AUDIO_ALLOW_SAMPLES_CHANGE);
+	if (mDevice == 0) {
+		printf("Unable to open audio device! SDL Error: %s\n", SDL_GetError());
+		SDL_QuitSubSystem(SDL_INIT_AUDIO);
+		return false;
+	}
+	mFrequency = have.freq;
+	mBufferSamples = have.samples;
+	mFrequencyTicks = SDL_GetPerformanceFrequency();
+	mMaxMixTicks = 0;
+	memset(mVoices, 0, sizeof(mVoices));
+	// the callback is paused until every effect exists
+	synthesize();
+	SDL_PauseAudioDevice(mDevice, 0);
+	return true;
+}
+
+void SoundMixer::close() {
+	if (mDevice == 0) {
+		return;
+	}
+	SDL_CloseAudioDevice(mDevice);
+	mDevice = 0;
+	SDL_QuitSubSystem(SDL_INIT_AUDIO);
+	for (int i = 0; i < SOUND_COUNT; i++) {
+		std::vector<Sint16>().swap(mEffects[i]);
+	}
+}
+
+void SoundMixer::play(SoundEffect effect, int volume) {
+	if (mDevice == 0) {
+		return;
+	}
+	SoundCommand command = { effect, volume };
+	if (mQueue.push(command)) {
+		mPlayed++;
+	} else {
+		mDropped++;
+	}
+}
+
+int SoundMixer::getPlayed() {
+	return mPlayed;
+}
+
+int SoundMixer::getDropped() {
+	return mDropped;
+}
+
+double SoundMixer::getMaxMixMs() {
+	return mMaxMixTicks.load() * 1000.0 / mFrequencyTicks;
+}
+
+double SoundMixer::getBufferMs() {
+	return mBufferSamples * 1000.0 / mFrequency;
+}
+
+void SoundMixer::synthesize() {
+	// short and bright, a low one for the walls, a falling one for a point
+	tone(SOUND_HIT, 880, 660, 60, true);
+	tone(SOUND_WALL, 330, 330, 40, true);
+	tone(SOUND_SCORE, 660, 110, 350, false);
+}
+
+void SoundMixer::tone(SoundEffect effect, double fromHz, double toHz, double ms, bool square) {
+	int length = (int)(mFrequency * ms / 1000.0);
+	std::vector<Sint16>& samples = mEffects[effect];
+	samples.resize(length);
+	const double pi = 3.14159265358979323846;
+	double phase = 0;
+	for (int i = 0; i < length; i++) {
+		double t = (double)i / length;
+		double hz = fromHz + (toHz - fromHz) * t;
+		phase += 2 * pi * hz / mFrequency;
+		double wave = std::sin(phase);
+		if (square) {
+			wave = wave >= 0 ? 0.5 : -0.5;
+		}
+		// quick attack against clicks, then a linear fade
+		double envelope = std::min(1.0, i / (mFrequency * 0.002)) * (1.0 - t);
+		samples[i] = (Sint16)(wave * envelope * 12000);
+	}
+}
+
+void SDLCALL SoundMixer::callback(void* userdata, Uint8* stream, int length) {
+	((SoundMixer*)userdata)->mix((Sint16*)stream, length / (int)sizeof(Sint16));
+}
+
+void SoundMixer::mix(Sint16* out, int samples) {
+	Uint64 start = SDL_GetPerformanceCounter();
+	// start what the game asked for since the last buffer
+	SoundCommand command;
+	while (mQueue.pop(&command)) {
+		int slot = 0;
+		for (int i = 0; i < SOUND_VOICES; i++) {
+			if (mVoices[i].samples == NULL) {
+				slot = i;
+				break;
+			}
+			// all busy, take the one furthest along
+			if (mVoices[i].position > mVoices[slot].position) {
+				slot = i;
+			}
+		}
+		Voice& voice = mVoices[slot];
+		voice.samples = mEffects[command.effect].empty() ? NULL : &mEffects[command.effect][0];
+		voice.length = (int)mEffects[command.effect].size();
+		voice.position = 0;
+		voice.volume = command.volume;
+	}
+
+	memset(out, 0, samples * sizeof(Sint16));
+	for (int v = 0; v < SOUND_VOICES; v++) {
+		Voice& voice = mVoices[v];
+		if (voice.samples == NULL) {
+			continue;
+		}
+		int count = std::min(samples, voice.length - voice.position);
+		const Sint16* in = voice.samples + voice.position;
+		for (int i = 0; i < count; i++) {
+			int value = out[i] + ((in[i] * voice.volume) >> 8);
+			out[i] = (Sint16)std::max(-32768, std::min(32767, value));
+		}
+		voice.position += count;
+		if (voice.position >= voice.length) {
+			voice.samples = NULL;
+		}
+	}
+
+	Uint64 ticks = SDL_GetPerformanceCounter() - start;
+	if (ticks > mMaxMixTicks.load(std::memory_order_relaxed)) {
+		mMaxMixTicks.store(ticks, std::memory_order_relaxed);
+	}
+}
@@ -0,0 +1,193 @@
+//////////////////////////////////////////////////////////////////////////
+// SpriteBatch.h
+//////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "../include/Tools.h"
+
+const int SPRITE_NAME_LENGTH = 32;
+
+// named clip of the sprite sheet
+struct SpriteFrame
+{
+	char name[SPRITE_NAME_LENGTH];
+	SDL_Rect clip;
+};
+
+// where every sprite sits in the sheet, read from a text file next to the image
+// one frame per line: name x y width height, lines starting with # are comments
+class SpriteAtlas
+{
+public:
+	// read frames at specified path
+	bool loadFromFile(std::string path);
+
+	// read frames from atlas text in memory
+	bool loadFromMemory(const char* text, int size);
+
+	// clip of a frame, NULL if the atlas has no such frame
+	const SDL_Rect* getFrame(const char* name);
+
+private:
+	// add the frame of one line, comments and bad lines are skipped
+	void parseLine(const char* line);
+
+	std::vector<SpriteFrame> mFrames;
+};
+
+// collects quads from one texture and draws them with a single geometry call
+class SpriteBatch
+{
+public:
+	SpriteBatch();
+
+	// start collecting quads from texture
+	void begin(LTexture* texture);
+	void begin(SDL_Texture* texture, int width, int height);
+
+	// queue clip of the texture at x, y, fractions place it between pixels
+	void draw(const SDL_Rect* clip, float x, float y);
+
+	// same, scaled to width and height
+	void draw(const SDL_Rect* clip, float x, float y, float w, float h);
+
+	// submit every queued quad, the batch is empty afterwards
+	void flush(SDL_Renderer* renderer);
+
+	int getSpriteCount();
+
+private:
+	SDL_Texture* mTexture;
+	int mWidth;
+	int mHeight;
+	int mCount;
+	// four corners per sprite, buffers keep their size between frames
+	std::vector<SDL_Vertex> mVertices;
+	// two triangles per sprite, only grows
+	std::vector<int> mIndices;
+};
+
+bool SpriteAtlas::loadFromFile(std::string path) {
+	mFrames.clear();
+	FILE* file = fopen(path.c_str(), "r");
+	if (file == NULL) {
+		printf("Unable to open sprite atlas %s!\n", path.c_str());
+		return false;
+	}
+	char line[128];
+	while (fgets(line, sizeof(line), file) != NULL) {
+		parseLine(line);
+	}
+	fclose(file);
+	return !mFrames.empty();
+}
+
+bool SpriteAtlas::loadFromMemory(const char* text, int size) {
+	mFrames.clear();
+	// text is not terminated, copy line by line
+	int start = 0;
+	while (start < size) {
+		int end = start;
+		while (end < size && text[end] != '\n') {
+			end++;
+		}
+		std::string line(text + start, end - start);
+		parseLine(line.c_str());
+		start = end + 1;
+	}
+	return !mFrames.empty();
+}
+
+void SpriteAtlas::parseLine(const char* line) {
+	if (line[0] == '#') {
+		return;
+	}
+	SpriteFrame frame;
+	if (sscanf(line, "%31s %d %d %d %d", frame.name, &frame.clip.x, &frame.clip.y, &frame.clip.w, &frame.clip.h) == 5) {
+		mFrames.push_back(frame);
+	}
+}
+
+const SDL_Rect* SpriteAtlas::getFrame(const char* name) {
+	for (size_t i = 0; i < mFrames.size(); i++) {
+		if (strcmp(mFrames[i].name, name) == 0) {
+			return &mFrames[i].clip;
+		}
+	}
+	printf("Sprite atlas has no frame %s!\n", name);
+	return NULL;
+}
+
+SpriteBatch::SpriteBatch() {
+	mTexture = NULL;
+	mWidth = 0;
+	mHeight = 0;
+	mCount = 0;
+}
+
+void SpriteBatch::begin(LTexture* texture) {
+	begin(texture->getTexture(), texture->getWidth(), texture->getHeight());
+}
+
+void SpriteBatch::begin(SDL_Texture* texture, int width, int height) {
+	mTexture = texture;
+	mWidth = width;
+	mHeight = height;
+	mCount = 0;
+}
+
+void SpriteBatch::draw(const SDL_Rect* clip, float x, float y) {
+	if (clip == NULL) {
+		return;
+	}
+	draw(clip, x, y, (float)clip->w, (float)clip->h);
+}
+
+void SpriteBatch::draw(const SDL_Rect* clip, float x, float y, float w, float h) {
+	int width = mWidth;
+	int height = mHeight;
+	if (clip == NULL || width == 0 || height == 0) {
+		return;
+	}
+	// grow buffers, indices never change once written
+	if ((int)mVertices.size() < (mCount + 1) * 4) {
+		mVertices.resize((mCount + 1) * 4);
+		int base = mCount * 4;
+		int quad[6] = { base, base + 1, base + 2, base, base + 2, base + 3 };
+		mIndices.insert(mIndices.end(), quad, quad + 6);
+	}
+
+	float left = x;
+	float top = y;
+	float right = left + w;
+	float bottom = top + h;
+	float u0 = (float)clip->x / width;
+	float v0 = (float)clip->y / height;
+	float u1 = (float)(clip->x + clip->w) / width;
+	float v1 = (float)(clip->y + clip->h) / height;
+	SDL_Color white = { 0xFF, 0xFF, 0xFF, 0xFF };
+	SDL_Vertex* corner = &mVertices[mCount * 4];
+	corner[0] = { { left, top }, white, { u0, v0 } };
+	corner[1] = { { right, top }, white, { u1, v0 } };
+	corner[2] = { { right, bottom }, white, { u1, v1 } };
+	corner[3] = { { left, bottom }, white, { u0, v1 } };
+	mCount++;
+}
+
+void SpriteBatch::flush(SDL_Renderer* renderer) {
+	// needs SDL 2.0.18 for SDL_RenderGeometry
+	if (mTexture != NULL && mCount > 0) {
+		SDL_RenderGeometry(renderer, mTexture, &mVertices[0], mCount * 4, &mIndices[0], mCount * 6);
+	}
+	mCount = 0;
+}
+
+int SpriteBatch::getSpriteCount() {
+	return mCount;
+}
@@ -4,48 +4,47 @@
 
 #pragma once
 
-#include "../include/Tools.h"
+#include "../include/SpriteBatch.h"
 
 class Sticky
 {
 public:
 	Sticky();
 	// constructor
-	Sticky(int x, int y, LTexture* texture, SDL_Rect* clip, int velX = 0, int velY = 0);
+	Sticky(float x, float y, const SDL_Rect* clip, float velX = 0, float velY = 0);
 
 	// move
 	void move();
 
-	// draw
-	void draw(SDL_Renderer* renderer);
+	// queue into the sprite batch
+	void draw(SpriteBatch* batch);
 
 	// set center position
-	void setStart(int x, int y);
+	void setStart(float x, float y);
 
 	// set velocity
-	void setVelocity(int x, int y);
+	void setVelocity(float x, float y);
 
 	// getter
-	int getStartX();
-	int getStartY();
-	int getVelocityX();
-	int getVelocityY();
+	float getStartX();
+	float getStartY();
+	float getVelocityX();
+	float getVelocityY();
 	int getWidth();
 	int getHeight();
 
 	~Sticky();
 
 private:
-	// start position
-	int mStartX;
-	int mStartY;
+	// start position in pixels, between two simulation ticks while interpolating
+	float mStartX;
+	float mStartY;
 	// velocity
-	int mVelocityX;
-	int mVelocityY;
+	float mVelocityX;
+	float mVelocityY;
 
-	// texture
-	LTexture* mTexture;
-	SDL_Rect* mClip;
+	// clip in the sprite sheet
+	const SDL_Rect* mClip;
 };
 
 Sticky::Sticky()
@@ -56,8 +55,8 @@ Sticky::~Sticky()
 {
 }
 
-Sticky::Sticky(int x, int y, LTexture* texture, SDL_Rect* clip, int velX, int velY) :
-	mStartX(x), mStartY(y), mTexture(texture), mClip(clip), mVelocityX(velX), mVelocityY(velY) {
+Sticky::Sticky(float x, float y, const SDL_Rect* clip, float velX, float velY) :
+	mStartX(x), mStartY(y), mClip(clip), mVelocityX(velX), mVelocityY(velY) {
 
 }
 
@@ -66,33 +65,33 @@ void Sticky::move() {
 	mStartY += mVelocityY;
 }
 
-void Sticky::draw(SDL_Renderer* renderer) {
-	mTexture->render(renderer, mStartX, mStartY, mClip);
+void Sticky::draw(SpriteBatch* batch) {
+	batch->draw(mClip, mStartX, mStartY);
 }
 
-void Sticky::setStart(int x, int y) {
+void Sticky::setStart(float x, float y) {
 	mStartX = x;
 	mStartY = y;
 }
 
-void Sticky::setVelocity(int x, int y) {
+void Sticky::setVelocity(float x, float y) {
 	mVelocityX = x;
 	mVelocityY = y;
 }
 
-int Sticky::getStartX() {
+float Sticky::getStartX() {
 	return mStartX;
 }
 
-int Sticky::getStartY() {
+float Sticky::getStartY() {
 	return mStartY;
 }
 
-int Sticky::getVelocityX() {
+float Sticky::getVelocityX() {
 	return mVelocityX;
 }
 
-int Sticky::getVelocityY() {
+float Sticky::getVelocityY() {
 	return mVelocityY;
 }
 
@@ -0,0 +1,181 @@
+//////////////////////////////////////////////////////////////////////////
+// Sweep.h
+//////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cmath>
+#include <algorithm>
+
+#include "../include/Constants.h"
+
+// swept circle collision, the ball is moved through the whole tick and
+// stopped at the time of impact, so it cannot tunnel at any speed.
+// every function is branch free so BatchWorld can vectorize it, and
+// Simulation uses the very same code for one match.
+// conditions are int instead of bool, the vectorizer cannot mix bool widths.
+// positions and velocities are subpixels, floats hold them exactly
+
+// time returned when nothing is hit
+const float SWEEP_NO_HIT = 1e30f;
+
+// all bits set when cond is true, lets conditions mix without bool vectors of different width
+inline int maskOf(bool cond) {
+	return -(int)cond;
+}
+
+// pick a where mask is set, b elsewhere
+inline int selectMask(int mask, int a, int b) {
+	return (a & mask) | (b & ~mask);
+}
+
+// nearest integer for subpixel positions, offset keeps the cast on positive values
+inline int roundSubpixel(float value) {
+	return (int)(value + 65536.5f) - 65536;
+}
+
+// first time in [0, maxTime] a circle moving by (vx, vy) per tick touches the box
+// returns SWEEP_NO_HIT if it does not, or only touches while moving away
+// outward normal of the touched side goes to nx, ny
+inline float sweepCircleBox(float x, float y, float vx, float vy, float radius,
+	float left, float top, float right, float bottom, float maxTime, float* nx, float* ny) {
+	const float big = SWEEP_NO_HIT;
+
+	// slabs of the box grown by radius
+	int movingX = vx != 0.0f;
+	int movingY = vy != 0.0f;
+	float invX = 1.0f / (movingX ? vx : 1.0f);
+	float invY = 1.0f / (movingY ? vy : 1.0f);
+	float tx0 = (left - radius - x) * invX;
+	float tx1 = (right + radius - x) * invX;
+	float ty0 = (top - radius - y) * invY;
+	float ty1 = (bottom + radius - y) * invY;
+	int inX = (x > left - radius) & (x < right + radius);
+	int inY = (y > top - radius) & (y < bottom + radius);
+	float nearX = movingX ? std::min(tx0, tx1) : (inX ? -big : big);
+	float farX = movingX ? std::max(tx0, tx1) : (inX ? big : -big);
+	float nearY = movingY ? std::min(ty0, ty1) : (inY ? -big : big);
+	float farY = movingY ? std::max(ty0, ty1) : (inY ? big : -big);
+	float enter = std::max(nearX, nearY);
+	float exit = std::min(farX, farY);
+	int slabHit = (enter <= exit) & (exit >= 0.0f) & (enter <= maxTime);
+	int startInside = enter < 0.0f;
+
+	// face contact, normal from the axis entered last
+	float t = std::max(enter, 0.0f);
+	float qx = x + vx * t;
+	float qy = y + vy * t;
+	int faceX = (qy >= top) & (qy <= bottom);
+	int faceY = (qx >= left) & (qx <= right);
+	int enterX = nearX > nearY;
+	float faceNx = enterX ? (vx > 0.0f ? -1.0f : 1.0f) : 0.0f;
+	float faceNy = enterX ? 0.0f : (vy > 0.0f ? -1.0f : 1.0f);
+
+	// corner contact, ray against a circle of radius around the corner
+	float cx = qx < left ? left : right;
+	float cy = qy < top ? top : bottom;
+	float dx = x - cx;
+	float dy = y - cy;
+	float a = vx * vx + vy * vy;
+	float b = dx * vx + dy * vy;
+	float c = dx * dx + dy * dy - radius * radius;
+	float disc = b * b - a * c;
+	float cornerT = (-b - std::sqrt(std::max(disc, 0.0f))) / (a > 0.0f ? a : 1.0f);
+	int cornerHit = (disc >= 0.0f) & (a > 0.0f) & (cornerT >= 0.0f) & (cornerT <= maxTime);
+	float cornerNx = (x + vx * cornerT - cx) / radius;
+	float cornerNy = (y + vy * cornerT - cy) / radius;
+
+	// already overlapping, normal from the closest point
+	float closeX = std::min(std::max(x, left), right);
+	float closeY = std::min(std::max(y, top), bottom);
+	float ox = x - closeX;
+	float oy = y - closeY;
+	float dist2 = ox * ox + oy * oy;
+	float dist = std::sqrt(dist2);
+	int centerInside = dist2 == 0.0f;
+	float overlapNx = centerInside ? 0.0f : ox / (dist > 0.0f ? dist : 1.0f);
+	float overlapNy = centerInside ? (y < (top + bottom) * 0.5f ? -1.0f : 1.0f) : oy / (dist > 0.0f ? dist : 1.0f);
+	int overlap = dist2 < radius * radius;
+
+	// pick the contact
+	int corner = (faceX | faceY) == 0;
+	float hitNx = startInside ? overlapNx : (corner ? cornerNx : faceNx);
+	float hitNy = startInside ? overlapNy : (corner ? cornerNy : faceNy);
+	float hitT = startInside ? 0.0f : (corner ? cornerT : t);
+	int hit = slabHit & (startInside ? overlap : (corner ? cornerHit : 1));
+	// only approaching contacts count, otherwise a ball leaving a sticky sticks to it
+	hit = hit & (vx * hitNx + vy * hitNy < 0.0f);
+
+	*nx = hitNx;
+	*ny = hitNy;
+	return hit ? hitT : big;
+}
+
+// first time in [0, maxTime] a circle moving by vx per tick touches a side wall
+// a ball already past the wall hits it at time 0
+inline float sweepCircleWalls(float x, float vx, float radius, float maxTime) {
+	float inv = 1.0f / (vx != 0.0f ? vx : 1.0f);
+	float tLeft = ((float)toSubpixels(GAME_AREA_LEFT) + radius - x) * inv;
+	float tRight = ((float)toSubpixels(GAME_AREA_RIGHT) - radius - x) * inv;
+	float t = vx < 0.0f ? tLeft : (vx > 0.0f ? tRight : SWEEP_NO_HIT);
+	t = std::max(t, 0.0f);
+	return t <= maxTime ? t : SWEEP_NO_HIT;
+}
+
+// resolve the earliest contact in the time left, or move to the end of the tick
+// sticky faces speed the ball up and pass on the sticky velocity like the
+// old changeBallSpeed, sticky sides and walls mirror the horizontal speed
+inline void sweepContact(float* x, float* y, int* velX, int* velY, float* remaining,
+	float playerX, float playerY, int playerVelX, float computerX, float computerY, int computerVelX) {
+	const float radius = (float)toSubpixels(BALL_RADIUS);
+	const float width = (float)toSubpixels(STICKY_WIDTH);
+	const float height = (float)toSubpixels(STICKY_HEIGHT);
+	int vx = *velX;
+	int vy = *velY;
+	float fvx = (float)vx;
+	float fvy = (float)vy;
+	float left = *remaining;
+
+	float wallT = sweepCircleWalls(*x, fvx, radius, left);
+	float playerNx, playerNy;
+	float playerT = sweepCircleBox(*x, *y, fvx, fvy, radius, playerX, playerY,
+		playerX + width, playerY + height, left, &playerNx, &playerNy);
+	float computerNx, computerNy;
+	float computerT = sweepCircleBox(*x, *y, fvx, fvy, radius, computerX, computerY,
+		computerX + width, computerY + height, left, &computerNx, &computerNy);
+
+	// earliest contact
+	float t = std::min(wallT, std::min(playerT, computerT));
+	float move = std::min(t, left);
+	*x += fvx * move;
+	*y += fvy * move;
+	*remaining = left - move;
+
+	// response
+	int hit = maskOf(t <= left);
+	int wallHit = hit & maskOf(wallT <= playerT) & maskOf(wallT <= computerT);
+	int playerHit = hit & maskOf(playerT < wallT) & maskOf(playerT <= computerT);
+	int computerHit = hit & maskOf(computerT < wallT) & maskOf(computerT < playerT);
+	float nx = playerHit != 0 ? playerNx : computerNx;
+	float ny = playerHit != 0 ? playerNy : computerNy;
+	int stickyVelX = selectMask(playerHit, playerVelX, computerVelX);
+	int face = (playerHit | computerHit) & maskOf(std::fabs(ny) >= std::fabs(nx));
+	int mirror = (wallHit | playerHit | computerHit) & ~face;
+	int speed = std::min(std::max(vy, -vy) + BALL_CHANGE_VELOCITY, BALL_MAX_VELOCITY);
+	int faceVelX = std::min(std::max(vx + stickyVelX, -BALL_MAX_VELOCITY), BALL_MAX_VELOCITY);
+	*velX = selectMask(face, faceVelX, selectMask(mirror, -vx, vx));
+	*velY = selectMask(face, selectMask(maskOf(ny < 0.0f), -speed, speed), vy);
+}
+
+// move the ball through one tick, bouncing off side walls and both stickies
+// contacts are unrolled so the cost per tick is constant
+inline void sweepBall(float* x, float* y, int* velX, int* velY,
+	float playerX, float playerY, int playerVelX, float computerX, float computerY, int computerVelX) {
+	float remaining = 1.0f;
+	sweepContact(x, y, velX, velY, &remaining, playerX, playerY, playerVelX, computerX, computerY, computerVelX);
+	sweepContact(x, y, velX, velY, &remaining, playerX, playerY, playerVelX, computerX, computerY, computerVelX);
+	sweepContact(x, y, velX, velY, &remaining, playerX, playerY, playerVelX, computerX, computerY, computerVelX);
+	// out of contacts, finish the tick in a straight line
+	*x += (float)*velX * remaining;
+	*y += (float)*velY * remaining;
+}
@@ -0,0 +1,48 @@
+//////////////////////////////////////////////////////////////////////////
+// TaskPool.h
+//////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <deque>
+#include <mutex>
+#include <vector>
+
+// job of one task, worker is the index of the thread running it
+typedef void (*TaskJob)(int index, int worker, void* context);
+
+// work stealing thread pool for independent tasks of uneven length.
+// every worker owns a queue, takes its own tasks from the back and
+// steals from the front of the others once its queue runs dry
+class TaskPool
+{
+public:
+	// 0 threads means one per core
+	TaskPool(int threads = 0);
+
+	// run job for every index in [0, count), returns when all are done
+	// the calling thread works as worker 0
+	void run(int count, TaskJob job, void* context);
+
+	int getThreadCount();
+
+private:
+	// queue of one worker
+	struct WorkerQueue
+	{
+		std::mutex lock;
+		std::deque<int> tasks;
+	};
+
+	// worker loop, runs until no queue has work left
+	void work(int worker, TaskJob job, void* context);
+
+	// next task of the worker itself
+	bool pop(int worker, int* index);
+
+	// task taken from another worker
+	bool steal(int worker, int* index);
+
+	int mThreadCount;
+	std::vector<WorkerQueue> mQueues;
+};
@@ -0,0 +1,316 @@
+//////////////////////////////////////////////////////////////////////////
+// TextAtlas.h
+//////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <SDL/SDL.h>
+#include <SDL/SDL_ttf.h>
+
+// printable ascii range kept in the atlas
+const int ATLAS_FIRST_CHAR = 32;
+const int ATLAS_LAST_CHAR = 126;
+const int ATLAS_CHAR_COUNT = ATLAS_LAST_CHAR - ATLAS_FIRST_CHAR + 1;
+const int ATLAS_WIDTH = 256;
+
+// glyph position in the atlas
+struct AtlasGlyph
+{
+	SDL_Rect rect;
+	int advance;
+};
+
+// every printable glyph of a font rasterized once into a single texture
+class TextAtlas
+{
+public:
+	// initializes variables
+	TextAtlas();
+
+	// deallocates memory
+	~TextAtlas();
+
+	// rasterize font at specified path
+	bool loadFromFile(SDL_Renderer* renderer, std::string path, int size);
+
+	// rasterize font file already in memory, data only has to live during the call
+	bool loadFromMemory(SDL_Renderer* renderer, const void* data, int dataSize, int size);
+
+	// rasterize an open font, the caller keeps it, e.g. a font of the asset cache
+	bool loadFromFont(SDL_Renderer* renderer, TTF_Font* font);
+
+	// deallocates texture
+	void freeAtlas();
+
+	// text dimensions in pixels
+	int getTextWidth(const char* text);
+	int getLineHeight();
+
+	// append two triangles per glyph to vertices, returns pen x after the text
+	int buildQuads(const char* text, int x, int y, SDL_Color color, std::vector<SDL_Vertex>& vertices);
+
+	// atlas texture
+	SDL_Texture* getTexture();
+
+	// counts loads, glyphs move when the atlas is loaded again
+	int getGeneration();
+
+private:
+	SDL_Texture* mTexture;
+	AtlasGlyph mGlyphs[ATLAS_CHAR_COUNT];
+	int mWidth;
+	int mHeight;
+	int mLineHeight;
+	int mGeneration;
+};
+
+// one line of text kept as atlas quads, rebuilt only when it changes
+class TextLine
+{
+public:
+	TextLine();
+
+	// rebuild quads when text, position or color differ
+	void setText(TextAtlas* atlas, const char* text, int x, int y, SDL_Color color);
+
+	// center text in the window around y
+	void setCenteredText(TextAtlas* atlas, const char* text, int windowWidth, int y, SDL_Color color);
+
+	// draw every glyph with one geometry call
+	void render(SDL_Renderer* renderer);
+
+	int getWidth();
+
+private:
+	TextAtlas* mAtlas;
+	int mGeneration;
+	std::string mText;
+	int mX;
+	int mY;
+	SDL_Color mColor;
+	int mWidth;
+	std::vector<SDL_Vertex> mVertices;
+};
+
+TextAtlas::TextAtlas() {
+	// initialize
+	mTexture = NULL;
+	mWidth = 0;
+	mHeight = 0;
+	mLineHeight = 0;
+	mGeneration = 0;
+	memset(mGlyphs, 0, sizeof(mGlyphs));
+}
+
+TextAtlas::~TextAtlas() {
+	// deallocate
+	freeAtlas();
+}
+
+bool TextAtlas::loadFromFile(SDL_Renderer* renderer, std::string path, int size) {
+	// get rid of preexisting atlas
+	freeAtlas();
+
+	TTF_Font* font = TTF_OpenFont(path.c_str(), size);
+	if (font == NULL) {
+		printf("Unable to load font %s! SDL_ttf Error: %s\n", path.c_str(), TTF_GetError());
+		return false;
+	}
+	bool success = loadFromFont(renderer, font);
+	TTF_CloseFont(font);
+	return success;
+}
+
+bool TextAtlas::loadFromMemory(SDL_Renderer* renderer, const void* data, int dataSize, int size) {
+	// get rid of preexisting atlas
+	freeAtlas();
+
+	// font closes the stream
+	TTF_Font* font = TTF_OpenFontRW(SDL_RWFromConstMem(data, dataSize), 1, size);
+	if (font == NULL) {
+		printf("Unable to load font from memory! SDL_ttf Error: %s\n", TTF_GetError());
+		return false;
+	}
+	bool success = loadFromFont(renderer, font);
+	TTF_CloseFont(font);
+	return success;
+}
+
+bool TextAtlas::loadFromFont(SDL_Renderer* renderer, TTF_Font* font) {
+	// get rid of preexisting atlas
+	freeAtlas();
+	mGeneration++;
+	mLineHeight = TTF_FontHeight(font);
+
+	// rasterize every glyph in white, color comes from the vertices
+	SDL_Color white = { 0xFF, 0xFF, 0xFF, 0xFF };
+	SDL_Surface* glyphs[ATLAS_CHAR_COUNT];
+	int penX = 0;
+	int penY = 0;
+	for (int i = 0; i < ATLAS_CHAR_COUNT; i++) {
+		char text[2] = { (char)(ATLAS_FIRST_CHAR + i), '\0' };
+		glyphs[i] = TTF_RenderText_Blended(font, text, white);
+		int w = 0;
+		int h = mLineHeight;
+		if (glyphs[i] != NULL) {
+			w = glyphs[i]->w;
+			h = glyphs[i]->h;
+		}
+		// next row
+		if (penX + w > ATLAS_WIDTH) {
+			penX = 0;
+			penY += mLineHeight;
+		}
+		mGlyphs[i].rect = { penX, penY, w, h };
+		mGlyphs[i].advance = w;
+		penX += w;
+	}
+	mWidth = ATLAS_WIDTH;
+	mHeight = penY + mLineHeight;
+
+	// copy glyphs into one surface, alpha included
+	SDL_Surface* atlas = SDL_CreateRGBSurfaceWithFormat(0, mWidth, mHeight, 32, SDL_PIXELFORMAT_ARGB8888);
+	if (atlas == NULL) {
+		printf("Unable to create atlas surface! SDL Error: %s\n", SDL_GetError());
+	} else {
+		SDL_FillRect(atlas, NULL, SDL_MapRGBA(atlas->format, 0xFF, 0xFF, 0xFF, 0));
+		for (int i = 0; i < ATLAS_CHAR_COUNT; i++) {
+			if (glyphs[i] != NULL) {
+				SDL_SetSurfaceBlendMode(glyphs[i], SDL_BLENDMODE_NONE);
+				SDL_BlitSurface(glyphs[i], NULL, atlas, &mGlyphs[i].rect);
+			}
+		}
+		mTexture = SDL_CreateTextureFromSurface(renderer, atlas);
+		if (mTexture == NULL) {
+			printf("Unable to create texture from atlas! SDL Error: %s\n", SDL_GetError());
+		} else {
+			SDL_SetTextureBlendMode(mTexture, SDL_BLENDMODE_BLEND);
+		}
+		SDL_FreeSurface(atlas);
+	}
+
+	// get rid of glyph surfaces
+	for (int i = 0; i < ATLAS_CHAR_COUNT; i++) {
+		if (glyphs[i] != NULL) {
+			SDL_FreeSurface(glyphs[i]);
+		}
+	}
+
+	// return success
+	return mTexture != NULL;
+}
+
+void TextAtlas::freeAtlas() {
+	if (mTexture != NULL) {
+		SDL_DestroyTexture(mTexture);
+		mTexture = NULL;
+		mWidth = 0;
+		mHeight = 0;
+	}
+}
+
+int TextAtlas::getTextWidth(const char* text) {
+	int width = 0;
+	for (const char* c = text; *c != '\0'; c++) {
+		int index = (unsigned char)*c - ATLAS_FIRST_CHAR;
+		if (index >= 0 && index < ATLAS_CHAR_COUNT) {
+			width += mGlyphs[index].advance;
+		}
+	}
+	return width;
+}
+
+int TextAtlas::getLineHeight() {
+	return mLineHeight;
+}
+
+int TextAtlas::buildQuads(const char* text, int x, int y, SDL_Color color, std::vector<SDL_Vertex>& vertices) {
+	if (mWidth == 0 || mHeight == 0) {
+		return x;
+	}
+	float invW = 1.0f / mWidth;
+	float invH = 1.0f / mHeight;
+	for (const char* c = text; *c != '\0'; c++) {
+		int index = (unsigned char)*c - ATLAS_FIRST_CHAR;
+		if (index < 0 || index >= ATLAS_CHAR_COUNT) {
+			continue;
+		}
+		const AtlasGlyph& glyph = mGlyphs[index];
+		// space and other empty glyphs only move the pen
+		if (glyph.rect.w > 0 && *c != ' ') {
+			float left = (float)x;
+			float top = (float)y;
+			float right = left + glyph.rect.w;
+			float bottom = top + glyph.rect.h;
+			float u0 = glyph.rect.x * invW;
+			float v0 = glyph.rect.y * invH;
+			float u1 = (glyph.rect.x + glyph.rect.w) * invW;
+			float v1 = (glyph.rect.y + glyph.rect.h) * invH;
+			SDL_Vertex quad[6] = {
+				{ { left, top }, color, { u0, v0 } },
+				{ { right, top }, color, { u1, v0 } },
+				{ { right, bottom }, color, { u1, v1 } },
+				{ { left, top }, color, { u0, v0 } },
+				{ { right, bottom }, color, { u1, v1 } },
+				{ { left, bottom }, color, { u0, v1 } }
+			};
+			vertices.insert(vertices.end(), quad, quad + 6);
+		}
+		x += glyph.advance;
+	}
+	return x;
+}
+
+SDL_Texture* TextAtlas::getTexture() {
+	return mTexture;
+}
+
+int TextAtlas::getGeneration() {
+	return mGeneration;
+}
+
+TextLine::TextLine() {
+	mAtlas = NULL;
+	mGeneration = 0;
+	mX = 0;
+	mY = 0;
+	mColor = { 0, 0, 0, 0 };
+	mWidth = 0;
+}
+
+void TextLine::setText(TextAtlas* atlas, const char* text, int x, int y, SDL_Color color) {
+	// nothing changed, keep old quads
+	if (atlas == mAtlas && atlas->getGeneration() == mGeneration && x == mX && y == mY && mText == text &&
+		color.r == mColor.r && color.g == mColor.g && color.b == mColor.b && color.a == mColor.a) {
+		return;
+	}
+	mAtlas = atlas;
+	mGeneration = atlas->getGeneration();
+	mText = text;
+	mX = x;
+	mY = y;
+	mColor = color;
+	mVertices.clear();
+	mWidth = atlas->buildQuads(text, x, y, color, mVertices) - x;
+}
+
+void TextLine::setCenteredText(TextAtlas* atlas, const char* text, int windowWidth, int y, SDL_Color color) {
+	int x = (windowWidth - atlas->getTextWidth(text)) / 2;
+	setText(atlas, text, x, y - atlas->getLineHeight() / 2, color);
+}
+
+void TextLine::render(SDL_Renderer* renderer) {
+	// needs SDL 2.0.18 for SDL_RenderGeometry
+	if (mAtlas != NULL && !mVertices.empty()) {
+		SDL_RenderGeometry(renderer, mAtlas->getTexture(), &mVertices[0], (int)mVertices.size(), NULL, 0);
+	}
+}
+
+int TextLine::getWidth() {
+	return mWidth;
+}
@@ -23,6 +23,9 @@ public:
 	// loads image at specified path
 	bool loadFromFile(SDL_Renderer* renderer, std::string path);
 
+	// creates image from ARGB8888 pixels with alpha, no conversion
+	bool loadFromPixels(SDL_Renderer* renderer, const void* pixels, int width, int height);
+
 	// creates image from font string
 	bool loadFromRenderedText(SDL_Renderer* renderer, std::string textureText, SDL_Color textColor);
 
@@ -44,6 +47,9 @@ public:
 	// set text texture font
 	void setFont(std::string font, int size);
 
+	// set text texture font from font file data, which has to outlive the font
+	void setFont(const void* data, int dataSize, int size);
+
 	// renders texture at given point
 	void render(SDL_Renderer* renderer, int x, int y, SDL_Rect* clip = NULL, double angle = 0.0, SDL_Point* center = NULL, SDL_RendererFlip flip = SDL_FLIP_NONE);
 
@@ -51,6 +57,9 @@ public:
 	int getWidth();
 	int getHeight();
 
+	// gets hardware texture
+	SDL_Texture* getTexture();
+
 private:
 	// the actual hardware texture
 	SDL_Texture* mTexture;
@@ -69,6 +78,7 @@ private:
 LTexture::LTexture(){
 	// initialize
 	mTexture = NULL;
+	mFont = NULL;
 	mWidth = 0;
 	mHeight = 0;
 }
@@ -113,6 +123,27 @@ bool LTexture::loadFromFile(SDL_Renderer* renderer, std::string path)
 	return mTexture != NULL;
 }
 
+bool LTexture::loadFromPixels(SDL_Renderer* renderer, const void* pixels, int width, int height) {
+	// get rid of preexisting texture
+	freeTexture();
+
+	// upload straight from memory
+	mTexture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STATIC, width, height);
+	if (mTexture == NULL) {
+		printf("Unable to create texture! SDL Error: %s\n", SDL_GetError());
+		return false;
+	}
+	if (SDL_UpdateTexture(mTexture, NULL, pixels, width * 4) != 0) {
+		printf("Unable to upload texture! SDL Error: %s\n", SDL_GetError());
+		freeTexture();
+		return false;
+	}
+	SDL_SetTextureBlendMode(mTexture, SDL_BLENDMODE_BLEND);
+	mWidth = width;
+	mHeight = height;
+	return true;
+}
+
 bool LTexture::loadFromRenderedText(SDL_Renderer* renderer, std::string textureText, SDL_Color textColor) {
 	// get rid of preexisting texture
 	if (mTexture != NULL){
@@ -186,6 +217,14 @@ void LTexture::setFont(std::string font, int size) {
 	mFont = TTF_OpenFont(font.c_str(), size);
 }
 
+void LTexture::setFont(const void* data, int dataSize, int size) {
+	if (mFont != NULL) {
+		TTF_CloseFont(mFont);
+	}
+	// font closes the stream
+	mFont = TTF_OpenFontRW(SDL_RWFromConstMem(data, dataSize), 1, size);
+}
+
 void LTexture::render(SDL_Renderer* renderer, int x, int y, SDL_Rect* clip, double angle, SDL_Point* center, SDL_RendererFlip flip){
 	// set rendering space and render to screen
 	SDL_Rect renderQuad = { x, y, mWidth, mHeight };
@@ -206,4 +245,8 @@ int LTexture::getWidth(){
 
 int LTexture::getHeight(){
 	return mHeight;
+}
+
+SDL_Texture* LTexture::getTexture(){
+	return mTexture;
 }
\ No newline at end of file
@@ -0,0 +1,89 @@
+//////////////////////////////////////////////////////////////////////////
+// Tournament.h
+//////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <vector>
+
+#include "../include/Policy.h"
+
+// rating every policy is centered on
+const double ELO_BASE = 1500.0;
+// fitting rounds for the ratings
+const int ELO_ROUNDS = 500;
+// tick limit per match
+const long long TOURNAMENT_MAX_TICKS = 200000;
+// tick limit per rally, a rally between two policies that never miss does not end.
+// it is served again, the next serve angle is what breaks the loop, not a miss
+const long long TOURNAMENT_MAX_RALLY_TICKS = 4800;
+
+// how the tournament is played
+struct TournamentSettings
+{
+	// matches per ordered pair, every pair also plays with sides swapped
+	int games;
+	unsigned int seed;
+	long long maxTicks;
+	long long maxRallyTicks;
+	// 0 means one per core
+	int threads;
+};
+
+// round robin between policies, every match runs on its own simulation
+// so the matches can be spread over all cores
+class Tournament
+{
+public:
+	Tournament(const std::vector<const PolicyEntry*>& policies);
+
+	// play every match, then fit the ratings
+	void run(const TournamentSettings& settings);
+
+	int getPolicyCount();
+	const PolicyEntry* getPolicy(int i);
+
+	// results of policy i against policy j
+	int getWins(int i, int j);
+	int getDraws(int i, int j);
+	int getGames(int i, int j);
+	// rallies served again in their games
+	int getStalledRallies(int i, int j);
+
+	double getElo(int i);
+
+	long long getTicks();
+	int getThreadCount();
+
+	// print ratings, win matrix and stalled rallies
+	void print();
+
+private:
+	// one match of the schedule
+	struct Match
+	{
+		int player;
+		int computer;
+		unsigned int seed;
+		MatchStats stats;
+	};
+
+	// task pool job, plays mMatches[index]
+	static void playJob(int index, int worker, void* context);
+
+	// bradley terry fit of the results, in elo points
+	void fitElo();
+
+	std::vector<const PolicyEntry*> mPolicies;
+	std::vector<Match> mMatches;
+	long long mMaxTicks;
+	long long mMaxRallyTicks;
+	// n x n tables, row is the policy, column the opponent
+	std::vector<int> mWins;
+	std::vector<int> mDraws;
+	std::vector<int> mGames;
+	std::vector<int> mStalled;
+	std::vector<double> mElo;
+	long long mTicks;
+	int mThreadCount;
+};
@@ -0,0 +1,249 @@
+//////////////////////////////////////////////////////////////////////////////////
+// Project: Pong
+// File:    AllocCounter.cpp
+//////////////////////////////////////////////////////////////////////////////////
+
+// replaces the global operator new, kept out of Main.cpp whose debug build redefines new.
+// only built in with PONG_ALLOC_COUNTER, otherwise the counter is never started
+
+#include <cstdlib>
+#include <new>
+#include <algorithm>
+
+#include <SDL/SDL.h>
+
+#include "../include/AllocCounter.h"
+
+static AllocCount gCount = { 0, 0 };
+static bool gRecording = false;
+static bool gBreak = false;
+static AllocSize gSizes[ALLOC_SIZE_SLOTS];
+static int gSizeCount = 0;
+static long long gUnlisted = 0;
+
+#ifdef PONG_ALLOC_COUNTER
+// only the thread that started the counter counts, encoder and pool threads allocate freely
+static thread_local bool tCounting = false;
+// inside the counter, the counter itself never allocates but SDL might call back
+static thread_local bool tInside = false;
+
+// SDL memory functions in place before the counter
+static SDL_malloc_func gSdlMalloc = NULL;
+static SDL_calloc_func gSdlCalloc = NULL;
+static SDL_realloc_func gSdlRealloc = NULL;
+static SDL_free_func gSdlFree = NULL;
+
+static void countAlloc(AllocSource source, size_t bytes) {
+	if (!tCounting || tInside) {
+		return;
+	}
+	tInside = true;
+	gCount.allocations++;
+	gCount.bytes += bytes;
+	if (gRecording) {
+		int i = 0;
+		while (i < gSizeCount && (gSizes[i].source != source || gSizes[i].bytes != bytes)) {
+			i++;
+		}
+		if (i < gSizeCount) {
+			gSizes[i].count++;
+		} else if (gSizeCount < ALLOC_SIZE_SLOTS) {
+			gSizes[gSizeCount].source = source;
+			gSizes[gSizeCount].bytes = bytes;
+			gSizes[gSizeCount].count = 1;
+			gSizeCount++;
+		} else {
+			gUnlisted++;
+		}
+	}
+	if (gBreak) {
+		// once, continuing in the debugger runs on
+		gBreak = false;
+		SDL_TriggerBreakpoint();
+	}
+	tInside = false;
+}
+
+static void* SDLCALL countedMalloc(size_t size) {
+	countAlloc(ALLOC_SDL, size);
+	return gSdlMalloc(size);
+}
+
+static void* SDLCALL countedCalloc(size_t count, size_t size) {
+	countAlloc(ALLOC_SDL, count * size);
+	return gSdlCalloc(count, size);
+}
+
+static void* SDLCALL countedRealloc(void* memory, size_t size) {
+	// may move the block, counted like a new one
+	countAlloc(ALLOC_SDL, size);
+	return gSdlRealloc(memory, size);
+}
+
+bool startAllocCounter() {
+	if (gSdlMalloc == NULL) {
+		SDL_GetMemoryFunctions(&gSdlMalloc, &gSdlCalloc, &gSdlRealloc, &gSdlFree);
+		// blocks allocated before still go to the same free
+		SDL_SetMemoryFunctions(countedMalloc, countedCalloc, countedRealloc, gSdlFree);
+	}
+	tCounting = true;
+	return true;
+}
+
+#else
+
+bool startAllocCounter() {
+	return false;
+}
+
+#endif
+
+AllocCount getAllocCount() {
+	return gCount;
+}
+
+void setAllocRecording(bool enabled) {
+	gRecording = enabled;
+}
+
+int getAllocSizes(AllocSize* sizes, int max) {
+	int count = std::min(max, gSizeCount);
+	AllocSize sorted[ALLOC_SIZE_SLOTS];
+	std::copy(gSizes, gSizes + gSizeCount, sorted);
+	std::sort(sorted, sorted + gSizeCount, [](const AllocSize& a, const AllocSize& b) {
+		return a.count > b.count;
+	});
+	std::copy(sorted, sorted + count, sizes);
+	return count;
+}
+
+long long getUnlistedAllocs() {
+	return gUnlisted;
+}
+
+void setAllocBreak(bool enabled) {
+	gBreak = enabled;
+}
+
+#ifdef PONG_ALLOC_COUNTER
+
+// global allocation functions, every other form of new and delete ends up in these
+static void* allocate(size_t size) {
+	countAlloc(ALLOC_NEW, size);
+	return malloc(size > 0 ? size : 1);
+}
+
+void* operator new(size_t size) {
+	void* memory = allocate(size);
+	if (memory == NULL) {
+		throw std::bad_alloc();
+	}
+	return memory;
+}
+
+void* operator new[](size_t size) {
+	return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+	return allocate(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+	return allocate(size);
+}
+
+void operator delete(void* memory) noexcept {
+	free(memory);
+}
+
+void operator delete[](void* memory) noexcept {
+	free(memory);
+}
+
+void operator delete(void* memory, const std::nothrow_t&) noexcept {
+	free(memory);
+}
+
+void operator delete[](void* memory, const std::nothrow_t&) noexcept {
+	free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept {
+	free(memory);
+}
+
+void operator delete[](void* memory, size_t) noexcept {
+	free(memory);
+}
+
+#ifdef __cpp_aligned_new
+// over-aligned types, their blocks need a free of their own on windows
+static void* allocateAligned(size_t size, std::align_val_t alignment) {
+	countAlloc(ALLOC_NEW, size);
+	size_t align = std::max((size_t)alignment, sizeof(void*));
+#ifdef _WIN32
+	return _aligned_malloc(size > 0 ? size : 1, align);
+#else
+	void* memory = NULL;
+	if (posix_memalign(&memory, align, size > 0 ? size : 1) != 0) {
+		return NULL;
+	}
+	return memory;
+#endif
+}
+
+static void freeAligned(void* memory) {
+#ifdef _WIN32
+	_aligned_free(memory);
+#else
+	free(memory);
+#endif
+}
+
+void* operator new(size_t size, std::align_val_t alignment) {
+	void* memory = allocateAligned(size, alignment);
+	if (memory == NULL) {
+		throw std::bad_alloc();
+	}
+	return memory;
+}
+
+void* operator new[](size_t size, std::align_val_t alignment) {
+	return operator new(size, alignment);
+}
+
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+	return allocateAligned(size, alignment);
+}
+
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+	return allocateAligned(size, alignment);
+}
+
+void operator delete(void* memory, std::align_val_t) noexcept {
+	freeAligned(memory);
+}
+
+void operator delete[](void* memory, std::align_val_t) noexcept {
+	freeAligned(memory);
+}
+
+void operator delete(void* memory, std::align_val_t, const std::nothrow_t&) noexcept {
+	freeAligned(memory);
+}
+
+void operator delete[](void* memory, std::align_val_t, const std::nothrow_t&) noexcept {
+	freeAligned(memory);
+}
+
+void operator delete(void* memory, size_t, std::align_val_t) noexcept {
+	freeAligned(memory);
+}
+
+void operator delete[](void* memory, size_t, std::align_val_t) noexcept {
+	freeAligned(memory);
+}
+#endif
+
+#endif
@@ -26,13 +26,32 @@
 
 #include <cstdio>
 #include <ctime>
+#include <cstring>
 
 #include <stack>
 
 #include "../include/Constants.h"
 #include "../include/Tools.h"
+#include "../include/TextAtlas.h"
+#include "../include/SpriteBatch.h"
+#include "../include/ScreenCache.h"
+#include "../include/FrameScheduler.h"
+#include "../include/FixedTimestep.h"
+#include "../include/AllocCounter.h"
+#include "../include/FrameProfiler.h"
+#include "../include/InputQueue.h"
+#include "../include/FrameCapture.h"
+#include "../include/Sound.h"
 #include "../include/Ball.h"
 #include "../include/Sticky.h"
+#include "../include/Simulation.h"
+#include "../include/Policy.h"
+#include "../include/Replay.h"
+#include "../include/Rewind.h"
+#include "../include/MultiBall.h"
+#include "../include/AssetBundle.h"
+#include "../include/AssetCache.h"
+#include "../include/NetPeer.h"
 
 using namespace std;
 
@@ -46,20 +65,78 @@ std::stack<StateStruct> gStageStack; // stack for game state pointer
 SDL_Window* gWindow = NULL; // SDL window pointer
 SDL_Renderer* gRenderer = NULL; // renderer pointer
 SDL_Event gEvent; // SDL event struct
-int gTimer; // timer
-LTexture gTextTexture;// texture for text
-LTexture gSprite;
-SDL_Rect gComputerStickyClip;
-SDL_Rect gPlayerStickyClip;
-SDL_Rect gBallClip;
-int gComputerScore = 0;
-int gPlayerScore = 0;
-int gBallSpeed = BALL_INIT_SPEED;
-
-Ball* gBall = NULL;// ball and sticky
-Sticky* gComputerSticky = NULL;
-Sticky* gPlayerSticky = NULL;
-bool gStart = true;
+FrameScheduler gScheduler; // frame pacing
+FixedTimestep gTimestep; // simulation ticks, independent of the frame rate
+int gFramesPerSecond = 0; // render rate, 0 follows the display
+ScreenCache gScreenCache; // static screens drawn once and presented on change
+bool gVsync = false; // present waits for the display
+bool gLowLatency = false; // game reads input as late as possible in the frame
+int gFrameQueue = 0; // frames the gpu may queue, 1 waits for it after every present, 0 leaves it to the driver
+bool gPresentAsap = false; // no pacing and no vsync, every frame is presented once drawn
+FrameProfiler gProfiler; // per phase frame timing
+InputQueue gInput; // decoded key presses with their time, read by the current state
+bool gShowProfiler = false; // timing overlay, toggled with F3
+const char* gProfileCsv = NULL; // timing written here on exit
+TextLine gProfilerText[PHASE_COUNT + 2]; // every phase, the input latency and heap allocations
+bool gAllocReport = false; // count heap allocations per frame and phase, report them on exit
+bool gAllocBreak = false; // trap into the debugger at the first allocation after the warm-up
+FrameCapture gCapture; // gameplay video, read back and written without stalling the frame
+const char* gCapturePath = NULL; // directory the captured frames go to
+CaptureFormat gCaptureFormat = CAPTURE_RAW;
+int gCaptureFps = CAPTURE_FRAMES_PER_SECOND;
+SoundMixer gSound; // effects mixed on the audio thread, the game only queues them
+bool gMute = false; // no audio device at all
+int gProfilerRefresh = 0;
+TextAtlas gTextAtlas;// glyphs for all text
+SDL_Color gTextColor = { 0xFF,0xFF,0xFF,0xFF };
+TextLine gStartText;// text built once in loadMedia
+TextLine gQuitText;
+TextLine gExitText;
+TextLine gWinText;
+TextLine gLoseText;
+TextLine gAgainText;
+TextLine gScoreText;// rebuilt when score changes
+int gShownPlayerScore = -1;
+int gShownComputerScore = -1;
+AssetBundle gAssets;// packed assets, mapped for the whole run
+AssetCache gCache;// textures and fonts by path, shared, reloaded when their files change
+const char* gAssetDir = NULL;// loose resources instead of the bundle, watched for changes
+CachedAsset* gSprite = NULL;
+CachedAsset* gFont = NULL;// font of the text atlas when it comes from gAssetDir
+int gFontVersion = 0;// font version the text atlas was built from
+SpriteAtlas gSpriteAtlas;// clips of the sprite sheet
+SpriteBatch gSpriteBatch;// every sprite of a frame in one draw call
+const SDL_Rect* gComputerStickyClip = NULL;
+const SDL_Rect* gPlayerStickyClip = NULL;
+const SDL_Rect* gBallClip = NULL;
+Simulation gSim; // game logic, score and entity state
+SimState gLastState; // state before the latest tick, drawn positions lie in between
+TickInput gPlayerInput = { 0, false }; // keyboard state for the next tick
+ComputerSkill gComputerSkill = SKILL_NORMAL; // how the computer sticky plays
+unsigned int gTick = 0; // ticks played in single player games
+SnapshotRing gRewind; // last seconds of play, always captured
+MultiBallWorld gMultiBall; // party balls around the match ball, none unless asked for
+int gMultiBallCount = 0;
+bool gRewinding = false; // rewind key is held
+unsigned int gSeed = 0; // random seed, stored in replays
+ReplayRecorder gRecorder; // input recording
+ReplayPlayer gReplay; // input playback
+const char* gRecordPath = NULL; // record input to this file
+const char* gReplayPath = NULL; // play input from this file
+bool gPlayback = false; // input comes from gReplay
+bool gFastReplay = false; // play the replay without window as fast as possible
+int gReplayRepeat = 1; // fast replay passes
+NetPeer gNet; // other player of a network game
+RollbackSession gRollback; // network game state, remote input is guessed and corrected
+bool gNetHost = false; // wait for another player to join
+const char* gNetJoin = NULL; // join the player hosting on this address
+int gNetPort = NET_DEFAULT_PORT;
+int gNetDelay = 0; // extra delay of received packets in ms, for testing on loopback
+TextLine gConnectText;
+
+Ball gBall;// ball and sticky, drawn from gSim state
+Sticky gComputerSticky;
+Sticky gPlayerSticky;
 
 // functions
 // init and close SDL, load media
@@ -67,6 +144,12 @@ bool initSDL();
 bool loadMedia();
 void closeSDL();
 
+// texts of the static screens, built again when the font changes
+void buildTexts();
+
+// pick up asset files saved since the last frame
+void reloadAssets();
+
 // init and shutdown game
 void init();
 void shutdown();
@@ -75,28 +158,93 @@ void shutdown();
 void Menu();
 void Game();
 void Exit();
+void Connect();
 
 void GameWin();
 void GameLose();
 
 // helper functions
+// every waiting event into gInput, window events are handled right away
+void pollInput();
+void quitGame();
 void handleMenuInput();
 void handleGameInput();
 void handleExitInput();
 
 void handleWinLoseInput();
-
-bool checkWallCollision(Sticky* sticky);
-bool checkWallCollision(Ball* ball);
-bool checkEntityCollision(Sticky* sticky, Ball *ball);
-void changeBallSpeed(Ball* ball);
-void changeComputerStickySpeed();
+void handleConnectInput();
+void handleWindowEvent();
+
+// one simulation tick of the game, false when the game state is over
+bool tickGame();
+bool rewindTick();
+
+// network game, both stickies are played by people
+bool isNetGame();
+bool openNetwork();
+void advanceNetGame(int ticks);
+
+// static screen content, drawn into gScreenCache
+void drawMenu();
+void drawExit();
+void drawWin();
+void drawLose();
+void drawConnect();
+
+// window state, nothing is rendered while it cannot be seen or used
+bool isWindowActive();
+void waitForWindow();
+
+void syncEntities(const SimState& last, const SimState& state, float alpha);
+// effects for what changed between two states, a hit, a bounce or a point
+void playSounds(const SimState& last, const SimState& state);
+float lerpPixels(int from, int to, float alpha);
+void updateScoreText(const SimState& state);
+void drawProfilerOverlay();
+// block until the gpu finished the presented frame
+void syncGpu();
+
+// command line options for the windowed game
+void parseOptions(int argc, char** argv);
+
+// headless mode
+bool parseHeadless(int argc, char** argv, int* matches, unsigned int* seed);
+void runHeadless(int matches, unsigned int seed);
+void runReplay();
 
 int main(int argc, char** argv) {
 	// detect memory leak
 	//_CrtSetBreakAlloc(1385);
 	_CrtSetDbgFlag(_CRTDBG_ALLOC_MEM_DF | _CRTDBG_LEAK_CHECK_DF);
 
+	// run matches without window
+	int matches = 0;
+	unsigned int seed = 0;
+	if (parseHeadless(argc, argv, &matches, &seed)) {
+		runHeadless(matches, seed);
+		return 0;
+	}
+	parseOptions(argc, argv);
+	// before SDL allocates anything
+	if (gAllocReport && !startAllocCounter()) {
+		printf("Unable to count allocations! Build with PONG_ALLOC_COUNTER.\n");
+		gAllocReport = false;
+		gAllocBreak = false;
+	}
+
+	// load recorded input
+	if (gReplayPath != NULL) {
+		if (!gReplay.load(gReplayPath)) {
+			printf("Failed to load replay!\n");
+			return 1;
+		}
+		gPlayback = true;
+		if (gFastReplay) {
+			runReplay();
+			return 0;
+		}
+	}
+
 	// start up SDL and create window
 	if (!initSDL()) {
 		printf("Failed to initialize!\n");
@@ -109,6 +257,25 @@ int main(int argc, char** argv) {
 			init();
 			// main loop
 			while (!gStageStack.empty()) {
+				// minimized, hidden or unfocused, sleep until the window comes back
+				// a network game keeps running, the other player would stall and time out
+				bool isNetState = isNetGame() && (gStageStack.top().StatePointer == Game || gStageStack.top().StatePointer == Connect);
+				if (!isNetState && !isWindowActive()) {
+					waitForWindow();
+					gTimestep.reset();
+					continue;
+				}
+				// saved asset files show up in the next frame
+				reloadAssets();
+				bool isStatic = gStageStack.top().StatePointer != Game && gStageStack.top().StatePointer != Connect;
+				// the low latency game waits inside the frame, right before it reads input
+				if (!gLowLatency || gStageStack.top().StatePointer != Game) {
+					gScheduler.waitForFrame(isStatic);
+				}
+				if (isStatic) {
+					// time spent on other screens is not played
+					gTimestep.reset();
+				}
 				gStageStack.top().StatePointer();
 			}
 
@@ -143,7 +310,11 @@ bool initSDL() {
 			success = false;
 		} else {
 			// create renderer for window
-			gRenderer = SDL_CreateRenderer(gWindow, -1, SDL_RENDERER_ACCELERATED);
+			Uint32 rendererFlags = SDL_RENDERER_ACCELERATED;
+			if (gVsync && !gPresentAsap) {
+				rendererFlags |= SDL_RENDERER_PRESENTVSYNC;
+			}
+			gRenderer = SDL_CreateRenderer(gWindow, -1, rendererFlags);
 			if (gRenderer == NULL) {
 				printf("Renderer could not be created! SDL Error: %s\n", SDL_GetError());
 				success = false;
@@ -174,27 +345,132 @@ bool loadMedia() {
 	// loading success flag
 	bool success = true;
 
-	gTextTexture.setFont("../resources/fonts/ARIAL.TTF", 12);
-	//gTextTexture.setFont("../../resources/fonts/ARIAL.TTF", 12);
+	// artists edit the loose files, the game picks up every save
+	gCache.init(gRenderer, gAssetDir != NULL);
+	std::string bundlePath = BUNDLE_FILE_NAME;
+	if (gAssetDir == NULL) {
+		// bundle next to the executable, no matter where we were started from
+		char* basePath = SDL_GetBasePath();
+		if (basePath != NULL) {
+			bundlePath = std::string(basePath) + BUNDLE_FILE_NAME;
+			SDL_free(basePath);
+		}
+		if (!gAssets.open(bundlePath)) {
+			printf("Failed to open asset bundle!\n");
+			return false;
+		}
+	}
+
+	// load text glyphs
+	if (gAssetDir != NULL) {
+		gFont = gCache.acquireFont(std::string(gAssetDir) + "/fonts/ARIAL.TTF", 12);
+		if (gFont == NULL || !gTextAtlas.loadFromFont(gRenderer, gFont->font)) {
+			printf("Failed to load font atlas!\n");
+			success = false;
+		} else {
+			gFontVersion = gFont->version;
+			buildTexts();
+		}
+	} else {
+		const BundleEntry* font = gAssets.find(BUNDLE_FONT);
+		if (font == NULL || !gTextAtlas.loadFromMemory(gRenderer, gAssets.getData(font), font->size, 12)) {
+			printf("Failed to load font atlas!\n");
+			success = false;
+		} else {
+			buildTexts();
+		}
+	}
 
-	// load sprite
-	gSprite.setColorKey(0xFF, 0, 0xFF);
-	if (!gSprite.loadFromFile(gRenderer, "../resources/images/Pong.bmp")) {
+	// load sprite, bundled pixels are keyed at build time and uploaded as they are
+	if (gAssetDir != NULL) {
+		SDL_Color key = { (Uint8)(SPRITE_COLOR_KEY >> 16), (Uint8)(SPRITE_COLOR_KEY >> 8), (Uint8)SPRITE_COLOR_KEY, 0xFF };
+		gSprite = gCache.acquireTexture(std::string(gAssetDir) + "/images/Pong.bmp", &key);
+	} else {
+		const BundleEntry* sprite = gAssets.find(BUNDLE_SPRITE);
+		if (sprite != NULL) {
+			gSprite = gCache.acquirePixels(bundlePath + ":" + BUNDLE_SPRITE, gAssets.getData(sprite), sprite->width, sprite->height);
+		}
+	}
+	if (gSprite == NULL) {
 		printf("Failed to load background image!\n");
 		success = false;
+	}
+	bool atlasLoaded = false;
+	if (gAssetDir != NULL) {
+		atlasLoaded = gSpriteAtlas.loadFromFile(std::string(gAssetDir) + "/images/Pong.atlas");
 	} else {
-		gComputerStickyClip = {COMPUTER_IMG_X,COMPUTER_IMG_Y,STICKY_WIDTH,STICKY_HEIGHT};
-		gPlayerStickyClip = { PLAYER_IMG_X,PLAYER_IMG_Y,STICKY_WIDTH,STICKY_HEIGHT };
-		gBallClip = {BALL_IMG_X,BALL_IMG_Y,BALL_RADIUS*2,BALL_RADIUS*2};
+		const BundleEntry* atlas = gAssets.find(BUNDLE_SPRITE_ATLAS);
+		atlasLoaded = atlas != NULL && gSpriteAtlas.loadFromMemory((const char*)gAssets.getData(atlas), atlas->size);
+	}
+	if (!atlasLoaded) {
+		printf("Failed to load sprite atlas!\n");
+		success = false;
+	} else {
+		gComputerStickyClip = gSpriteAtlas.getFrame(SPRITE_COMPUTER_STICKY);
+		gPlayerStickyClip = gSpriteAtlas.getFrame(SPRITE_PLAYER_STICKY);
+		gBallClip = gSpriteAtlas.getFrame(SPRITE_BALL);
+		if (gComputerStickyClip == NULL || gPlayerStickyClip == NULL || gBallClip == NULL) {
+			success = false;
+		}
+	}
+
+	// target for static screens
+	gScreenCache.init(gRenderer, WINDOW_WIDTH, WINDOW_HEIGHT);
+
+	// effects are built into pcm here, the game plays on without a device
+	if (!gMute && !gSound.open()) {
+		printf("Failed to open audio, playing without sound!\n");
 	}
 
 	return success;
 }
 
+void buildTexts() {
+	int centerY = WINDOW_HEIGHT / 2;
+	gStartText.setCenteredText(&gTextAtlas, "Start (G)ame", WINDOW_WIDTH, centerY - 10, gTextColor);
+	gQuitText.setCenteredText(&gTextAtlas, "(Q)uit Game", WINDOW_WIDTH, centerY + 10, gTextColor);
+	gExitText.setCenteredText(&gTextAtlas, "Quit Game (Y or N)?", WINDOW_WIDTH, centerY, gTextColor);
+	gWinText.setCenteredText(&gTextAtlas, "You Win!!!", WINDOW_WIDTH, centerY - 10, gTextColor);
+	gLoseText.setCenteredText(&gTextAtlas, "You Lose.", WINDOW_WIDTH, centerY - 10, gTextColor);
+	gAgainText.setCenteredText(&gTextAtlas, "Quit Game (Y or N)?", WINDOW_WIDTH, centerY + 10, gTextColor);
+	gConnectText.setCenteredText(&gTextAtlas, "Waiting for the other player...", WINDOW_WIDTH, centerY, gTextColor);
+}
+
+void reloadAssets() {
+	if (gCache.poll() == 0) {
+		return;
+	}
+	// textures changed in place, glyphs of a new font have to be laid out again
+	if (gFont != NULL && gFont->version != gFontVersion && gTextAtlas.loadFromFont(gRenderer, gFont->font)) {
+		gFontVersion = gFont->version;
+		buildTexts();
+		gShownPlayerScore = -1;
+		gProfilerRefresh = 0;
+	}
+	// static screens hold the old assets, draw them again instead of presenting the cached target
+	gScreenCache.reset();
+}
+
 void closeSDL() {
+	// stop the audio thread first
+	if (gSound.getPlayed() > 0) {
+		printf("Played %d sounds, dropped %d, slowest mix %.3f ms of a %.2f ms buffer.\n", gSound.getPlayed(), gSound.getDropped(),
+			gSound.getMaxMixMs(), gSound.getBufferMs());
+	}
+	gSound.close();
+
 	// free texture
-	gTextTexture.freeTexture();
-	gSprite.freeTexture();
+	gScreenCache.freeCache();
+	gTextAtlas.freeAtlas();
+	gCache.release(gSprite);
+	gCache.release(gFont);
+	gSprite = NULL;
+	gFont = NULL;
+	if (gAssetDir != NULL) {
+		gCache.printUsage();
+	}
+	gCache.freeCache();
+	gAssets.close();
 
 	// destroy window	
 	SDL_DestroyRenderer(gRenderer);
@@ -209,11 +485,41 @@ void closeSDL() {
 }
 
 void init() {
-	// get the number of ticks
-	gTimer = SDL_GetTicks();
+	// frame pacing, render at the display refresh rate unless told otherwise
+	int framesPerSecond = gFramesPerSecond;
+	if (framesPerSecond <= 0) {
+		SDL_DisplayMode mode;
+		if (SDL_GetCurrentDisplayMode(SDL_GetWindowDisplayIndex(gWindow), &mode) == 0 && mode.refresh_rate > 0) {
+			framesPerSecond = mode.refresh_rate;
+		} else {
+			framesPerSecond = FRAMES_PER_SECOND;
+		}
+	}
+	gScheduler.init(framesPerSecond, gVsync && !gPresentAsap, gPresentAsap);
+	gTimestep.init(TICKS_PER_SECOND);
+	gProfiler.init();
+	if (gAllocReport) {
+		gProfiler.countAllocations(gAllocBreak);
+	}
+	gInput.init();
+	if (gCapturePath != NULL && !gCapture.start(gRenderer, WINDOW_WIDTH, WINDOW_HEIGHT, gCapturePath, gCaptureFormat, gCaptureFps)) {
+		printf("Failed to start frame capture!\n");
+	}
 
-	// seed our random number generator
-	srand(time(0));
+	// seed our random number generator, replays bring their own seed
+	gSeed = gPlayback ? gReplay.getSeed() : (unsigned int)time(0);
+	srand(gSeed);
+	if (gPlayback) {
+		gComputerSkill = gReplay.getSkill();
+	}
+	gSim.setComputerSkill(gComputerSkill);
+	gSim.reset();
+	gLastState = gSim.getState();
+	// both players of a network game would have to step them
+	gMultiBall.reset(isNetGame() ? 0 : gMultiBallCount, gSeed);
+	if (gRecordPath != NULL) {
+		gRecorder.begin(gSeed, gComputerSkill);
+	}
 	
 	// add a pointer to exit state
 	StateStruct state;
@@ -224,482 +530,758 @@ void init() {
 	state.StatePointer = Menu;
 	gStageStack.push(state);
 
+	// replays start right in the game
+	if (gPlayback) {
+		state.StatePointer = Game;
+		gStageStack.push(state);
+	}
+
 	// sticky and ball
-	gBall = new Ball(BALL_START_X, BALL_START_Y, &gSprite, &gBallClip);
-	gComputerSticky = new Sticky(COMPUTER_START_X, COMPUTER_START_Y, &gSprite, &gComputerStickyClip);
-	gPlayerSticky = new Sticky(PLAYER_START_X, PLAYER_START_Y, &gSprite, &gPlayerStickyClip);
+	gBall = Ball(BALL_START_X, BALL_START_Y, gBallClip);
+	gComputerSticky = Sticky(COMPUTER_START_X, COMPUTER_START_Y, gComputerStickyClip);
+	gPlayerSticky = Sticky(PLAYER_START_X, PLAYER_START_Y, gPlayerStickyClip);
 }
 
 void shutdown() {
-	// deallocate
-	delete gBall;
-	delete gComputerSticky;
-	delete gPlayerSticky;
+	// input recording
+	if (gRecordPath != NULL) {
+		gRecorder.save(gRecordPath);
+	}
+
+	// gameplay video, frames still queued are written first
+	gCapture.stop();
+
+	// frame timing
+	if (gProfileCsv != NULL) {
+		gProfiler.writeCsv(gProfileCsv);
+	}
 
-	gBall = NULL;
-	gComputerSticky = NULL;
-	gPlayerSticky = NULL;
+	// heap allocations of the game frames
+	if (gAllocReport) {
+		gProfiler.printAllocReport();
+	}
 }
 
 // game menu
 void Menu() {
-	// control FPS
-	if ((SDL_GetTicks() - gTimer) >= FRAME_RATE) {
-		// handle input
-		handleMenuInput();
-
-		// clear screen
-		SDL_SetRenderDrawColor(gRenderer, 0, 0, 0, 0xFF);
-		SDL_RenderClear(gRenderer);
-
-		// render
-		SDL_Color textColor = { 0xFF,0xFF,0xFF };
-		int textX = (WINDOW_WIDTH - gTextTexture.getWidth()) / 2;
-		int textY = (WINDOW_HEIGHT - gTextTexture.getHeight()) / 2;
-		gTextTexture.loadFromRenderedText(gRenderer, "Start (G)ame", textColor);
-		gTextTexture.render(gRenderer, textX, textY - 10);
-		gTextTexture.loadFromRenderedText(gRenderer, "(Q)uit Game", textColor);
-		gTextTexture.render(gRenderer, textX, textY + 10);
+	// handle input
+	handleMenuInput();
 
-		// update
-		SDL_RenderPresent(gRenderer);
-		gTimer = SDL_GetTicks();
-	}
+	// render, only presents when the screen changed
+	gScreenCache.show(gRenderer, drawMenu);
 }
 
 // main game
 void Game() {
-	// control FPS
-	if ((SDL_GetTicks() - gTimer) >= FRAME_RATE) {
-		handleGameInput();
-
-		// player sticky move
-		if (!checkWallCollision(gPlayerSticky)) {
-			gPlayerSticky->move();
-		}
-		// computer sticky move
-		changeComputerStickySpeed();
-		if (!checkWallCollision(gComputerSticky)) {
-			gComputerSticky->move();
-		}
-		// ball move
-		/*if (!checkEntityCollision(gPlayerSticky, gBall) && 
-			!checkEntityCollision(gComputerSticky, gBall) && 
-			!checkWallCollision(gBall)) {
-			gBall->move();
-		}*/
-		changeBallSpeed(gBall);
-		gBall->move();
-
-		// clear screen
+	gProfiler.beginFrame();
+	// recorded frames are drawn offscreen first
+	gCapture.beginFrame();
+	if (gLowLatency) {
+		// text does not depend on input, draw it first and wait with input for the last moment
+		// score text may show the score of the frame before, the ball is back in the middle then
+		gProfiler.begin(PHASE_TEXT);
 		SDL_SetRenderDrawColor(gRenderer, 0, 0, 0, 0xFF);
 		SDL_RenderClear(gRenderer);
+		updateScoreText(isNetGame() ? gRollback.getState() : gSim.getState());
+		gScoreText.render(gRenderer);
+		drawProfilerOverlay();
+		gProfiler.end(PHASE_TEXT);
+		gScheduler.waitForLatch();
+	}
 
-		// render
-		// draw sticky and ball
-		gComputerSticky->draw(gRenderer);
-		gPlayerSticky->draw(gRenderer);
-		gBall->draw(gRenderer);
-		// draw score text
-		SDL_Color textColor = { 0xFF,0xFF,0xFF };
-		string scoreText = "Player Score: " + to_string(gPlayerScore)+"   Computer Score: "+to_string(gComputerScore);
-		gTextTexture.loadFromRenderedText(gRenderer, scoreText, textColor);
-		gTextTexture.render(gRenderer, 0, 0);
-		
-
-		// update
-		SDL_RenderPresent(gRenderer);
-		gTimer = SDL_GetTicks();
+	gProfiler.begin(PHASE_INPUT);
+	handleGameInput();
+	gProfiler.end(PHASE_INPUT);
+
+	// sticky and ball move, as many fixed ticks as are due
+	gProfiler.begin(PHASE_SIMULATION);
+	int ticks = gTimestep.advance();
+	if (isNetGame()) {
+		// a correction may replay a sound, a missed one is worse
+		SimState last = gRollback.getState();
+		advanceNetGame(ticks);
+		playSounds(last, gRollback.getState());
+	} else {
+		for (int i = 0; i < ticks; i++) {
+			if (gRewinding && !gPlayback) {
+				// scrub back, stays at the oldest snapshot when the ring runs out
+				for (int j = 0; j < REWIND_SPEED; j++) {
+					rewindTick();
+				}
+			} else if (!tickGame()) {
+				break;
+			}
+		}
 	}
-}
+	const SimState& state = isNetGame() ? gRollback.getState() : gSim.getState();
+	syncEntities(isNetGame() ? gRollback.getPreviousState() : gLastState, state, gTimestep.getAlpha());
+	gProfiler.end(PHASE_SIMULATION);
 
-// exit state
-void Exit() {
-	// control FPS
-	if ((SDL_GetTicks() - gTimer) >= FRAME_RATE) {
-		handleExitInput();
-		// clear screen
+	// clear screen
+	gProfiler.begin(PHASE_DRAW);
+	if (!gLowLatency) {
 		SDL_SetRenderDrawColor(gRenderer, 0, 0, 0, 0xFF);
 		SDL_RenderClear(gRenderer);
+	}
 
-		// render
-		SDL_Color textColor = { 0xFF,0xFF,0xFF };
-		int textX = (WINDOW_WIDTH - gTextTexture.getWidth()) / 2;
-		int textY = (WINDOW_HEIGHT - gTextTexture.getHeight()) / 2;
-		gTextTexture.loadFromRenderedText(gRenderer, "Quit Game (Y or N)?", textColor);
-		gTextTexture.render(gRenderer, textX, textY);
+	// render
+	// draw sticky and ball, one geometry call for all sprites
+	gSpriteBatch.begin(gSprite->texture, gSprite->width, gSprite->height);
+	gComputerSticky.draw(&gSpriteBatch);
+	gPlayerSticky.draw(&gSpriteBatch);
+	gBall.draw(&gSpriteBatch);
+	// party balls, the ball sprite scaled down, drawn where the last tick left them
+	const int* partyX = gMultiBall.getBallX();
+	const int* partyY = gMultiBall.getBallY();
+	const float partyScale = 1.0f / SUBPIXELS;
+	for (int i = 0; i < gMultiBall.getCount(); i++) {
+		gSpriteBatch.draw(gBallClip, partyX[i] * partyScale - MULTIBALL_RADIUS, partyY[i] * partyScale - MULTIBALL_RADIUS,
+			2 * MULTIBALL_RADIUS, 2 * MULTIBALL_RADIUS);
+	}
+	gSpriteBatch.flush(gRenderer);
+	gProfiler.end(PHASE_DRAW);
+	// draw score text
+	if (!gLowLatency) {
+		gProfiler.begin(PHASE_TEXT);
+		updateScoreText(state);
+		gScoreText.render(gRenderer);
+		drawProfilerOverlay();
+		gProfiler.end(PHASE_TEXT);
+	}
 
-		// update
-		SDL_RenderPresent(gRenderer);
-		gTimer = SDL_GetTicks();
+	// update
+	gProfiler.begin(PHASE_PRESENT);
+	gCapture.endFrame();
+	SDL_RenderPresent(gRenderer);
+	if (gFrameQueue == 1) {
+		syncGpu();
 	}
+	gScheduler.framePresented();
+	gProfiler.presented();
+	// window no longer shows the cached screen
+	gScreenCache.invalidate();
+	gProfiler.end(PHASE_PRESENT);
+	// apart from the present, whether the readback waits depends on the renderer
+	gProfiler.begin(PHASE_CAPTURE);
+	gCapture.collect();
+	gProfiler.end(PHASE_CAPTURE);
+	gProfiler.endFrame();
+}
+
+// exit state
+void Exit() {
+	handleExitInput();
+	// render, only presents when the screen changed
+	gScreenCache.show(gRenderer, drawExit);
 }
 
 void GameWin() {
-	if ((SDL_GetTicks() - gTimer) >= FRAME_RATE) {
-		handleWinLoseInput();
-		// clear screen
-		SDL_SetRenderDrawColor(gRenderer, 0, 0, 0, 0xFF);
-		SDL_RenderClear(gRenderer);
+	handleWinLoseInput();
+	// render, only presents when the screen changed
+	gScreenCache.show(gRenderer, drawWin);
+}
 
-		// render
-		SDL_Color textColor = { 0xFF,0xFF,0xFF };
-		int textX = (WINDOW_WIDTH - gTextTexture.getWidth()) / 2;
-		int textY = (WINDOW_HEIGHT - gTextTexture.getHeight()) / 2;
-		gTextTexture.loadFromRenderedText(gRenderer, "You Win!!!", textColor);
-		gTextTexture.render(gRenderer, textX, textY-10);
-		gTextTexture.loadFromRenderedText(gRenderer, "Quit Game (Y or N)?", textColor);
-		gTextTexture.render(gRenderer, textX, textY+10);
+void GameLose() {
+	handleWinLoseInput();
+	// render, only presents when the screen changed
+	gScreenCache.show(gRenderer, drawLose);
+}
 
-		// update
-		SDL_RenderPresent(gRenderer);
-		gTimer = SDL_GetTicks();
+// wait for the other player of a network game
+void Connect() {
+	handleConnectInput();
+	if (!gStageStack.empty() && gStageStack.top().StatePointer == Connect && gNet.connect(SDL_GetTicks())) {
+		// both start at tick 0 now, time sync evens out who started first
+		gRollback.begin(gNet.getLocalSide());
+		gTimestep.reset();
+		gStageStack.pop();
+		StateStruct state;
+		state.StatePointer = Game;
+		gStageStack.push(state);
+		return;
 	}
+	// render, only presents when the screen changed
+	gScreenCache.show(gRenderer, drawConnect);
 }
 
-void GameLose() {
-	if ((SDL_GetTicks() - gTimer) >= FRAME_RATE) {
-		handleWinLoseInput();
-		// clear screen
-		SDL_SetRenderDrawColor(gRenderer, 0, 0, 0, 0xFF);
-		SDL_RenderClear(gRenderer);
+void drawMenu() {
+	gStartText.render(gRenderer);
+	gQuitText.render(gRenderer);
+}
+
+void drawExit() {
+	gExitText.render(gRenderer);
+}
 
-		// render
-		SDL_Color textColor = { 0xFF,0xFF,0xFF };
-		int textX = (WINDOW_WIDTH - gTextTexture.getWidth()) / 2;
-		int textY = (WINDOW_HEIGHT - gTextTexture.getHeight()) / 2;
-		gTextTexture.loadFromRenderedText(gRenderer, "You Lose.", textColor);
-		gTextTexture.render(gRenderer, textX, textY - 10);
-		gTextTexture.loadFromRenderedText(gRenderer, "Quit Game (Y or N)?", textColor);
-		gTextTexture.render(gRenderer, textX, textY+10);
+void drawWin() {
+	gWinText.render(gRenderer);
+	gAgainText.render(gRenderer);
+}
 
-		// update
-		SDL_RenderPresent(gRenderer);
-		gTimer = SDL_GetTicks();
-	}
+void drawLose() {
+	gLoseText.render(gRenderer);
+	gAgainText.render(gRenderer);
+}
+
+void drawConnect() {
+	gConnectText.render(gRenderer);
 }
 
 // receive input handle it for menu state
 void handleMenuInput() {
-	// get event information
-	while (SDL_PollEvent(&gEvent) != 0) {
-		// handle user manually closing game window
-		if (gEvent.type == SDL_QUIT) {
-			// pop all state
-			while (!gStageStack.empty()) {
-				gStageStack.pop();
-			}
-			return;// game is over, exit the function
+	pollInput();
+	InputEvent input;
+	while (gInput.pop(&input)) {
+		if (!input.pressed) {
+			continue;
 		}
-		// handle keyboard input
-		if (gEvent.type == SDL_KEYDOWN) {
-			switch (gEvent.key.keysym.sym)
-			{
-			case SDLK_ESCAPE:
-			case SDLK_q:
-				gStageStack.pop();
-				return;// this state is done, exit the function
-				break;
-			case SDLK_g:
-				StateStruct temp;
-				temp.StatePointer = Game;// add a pointer to game state
-				gStageStack.push(temp);
-				return;// this state is done, exit the function
-				break;
-			default:
-				break;
+		switch (input.command)
+		{
+		case INPUT_QUIT:
+			quitGame();
+			return;// game is over, exit the function
+		case INPUT_BACK:
+		case INPUT_LEAVE:
+			gStageStack.pop();
+			return;// this state is done, exit the function
+		case INPUT_START:
+			StateStruct temp;
+			temp.StatePointer = Game;// add a pointer to game state
+			if (isNetGame()) {
+				// wait for the other player first
+				if (!openNetwork()) {
+					break;
+				}
+				temp.StatePointer = Connect;
 			}
+			gStageStack.push(temp);
+			return;// this state is done, exit the function
+		default:
+			break;
 		}
 	}
 }
 
 // receive input handle it for main game
 void handleGameInput() {
-	// get event information
-	while (SDL_PollEvent(&gEvent) != 0) {
-		// handle user manually closing game window
-		if (gEvent.type == SDL_QUIT) {
-			// pop all state
-			while (!gStageStack.empty()) {
-				gStageStack.pop();
-			}
+	pollInput();
+	InputEvent input;
+	while (gInput.pop(&input)) {
+		switch (input.command)
+		{
+		case INPUT_QUIT:
+			quitGame();
 			return;// game is over, exit the function
-		}
-		// handle keyboard input
-		if (gEvent.type == SDL_KEYDOWN) {
-			switch (gEvent.key.keysym.sym)
-			{
-			case SDLK_ESCAPE:
+		case INPUT_BACK:
+			if (input.pressed) {
+				// the other player sees the connection drop
+				gNet.close();
 				gStageStack.pop();
 				return;// this state is done, exit the function
-				break;
-			case SDLK_SPACE:
-				if (gStart) {
-					gStart = false;
-					gBall->setVelocity(0, gBallSpeed);
-				}
-				break;
-			case SDLK_LEFT:
-				gPlayerSticky->setVelocity(-STICKY_SPEED, 0);
-				break;
-			case SDLK_RIGHT:
-				gPlayerSticky->setVelocity(STICKY_SPEED, 0);
-				break;
-			default:
-				break;
 			}
-		}
-		if (gEvent.type == SDL_KEYUP) {
-			switch (gEvent.key.keysym.sym)
-			{
-			case SDLK_LEFT:
-				gPlayerSticky->setVelocity(0, 0);
-				break;
-			case SDLK_RIGHT:
-				gPlayerSticky->setVelocity(0, 0);
-				break;
-			default:
-				break;
+			break;
+		case INPUT_SERVE:
+			if (input.pressed) {
+				gPlayerInput.serve = true;
+				gProfiler.inputConsumed(input.time);
+			}
+			break;
+		case INPUT_LEFT:
+		case INPUT_RIGHT:
+			if (input.pressed) {
+				gPlayerInput.direction = input.command == INPUT_LEFT ? -1 : 1;
+			} else {
+				gPlayerInput.direction = 0;
 			}
+			gProfiler.inputConsumed(input.time);
+			break;
+		case INPUT_PROFILER:
+			if (input.pressed) {
+				gShowProfiler = !gShowProfiler;
+				gProfilerRefresh = 0;
+			}
+			break;
+		case INPUT_REWIND:
+			// network games can not go back
+			gRewinding = input.pressed && !isNetGame();
+			break;
+		default:
+			break;
 		}
 	}
 }
 
 // receive input handle it for exit state
 void handleExitInput() {
-	// get event information
-	while (SDL_PollEvent(&gEvent) != 0) {
-		// handle user manually closing game window
-		if (gEvent.type == SDL_QUIT) {
-			// pop all state
-			while (!gStageStack.empty()) {
-				gStageStack.pop();
-			}
-			return;// game is over, exit the function
+	pollInput();
+	InputEvent input;
+	while (gInput.pop(&input)) {
+		if (!input.pressed) {
+			continue;
 		}
-		// handle keyboard input
-		if (gEvent.type == SDL_KEYDOWN) {
-			switch (gEvent.key.keysym.sym)
-			{
-			case SDLK_ESCAPE:
-				gStageStack.pop();
-				return;// this state is done, exit the function
-				break;
-			// Yes
-			case SDLK_y:
-				gStageStack.pop();
-				return;// game is over, exit the function
-				break;
-			// No
-			case SDLK_n:
-				StateStruct temp;
-				temp.StatePointer = Menu;
-				gStageStack.push(temp);
-				return;// this state is done, exit the function
-				break;
-			default:
-				break;
-			}
+		switch (input.command)
+		{
+		case INPUT_QUIT:
+			quitGame();
+			return;// game is over, exit the function
+		case INPUT_BACK:
+			gStageStack.pop();
+			return;// this state is done, exit the function
+		// Yes
+		case INPUT_YES:
+			gStageStack.pop();
+			return;// game is over, exit the function
+		// No
+		case INPUT_NO:
+			StateStruct temp;
+			temp.StatePointer = Menu;
+			gStageStack.push(temp);
+			return;// this state is done, exit the function
+		default:
+			break;
 		}
 	}
 }
 
 void handleWinLoseInput() {
-	while (SDL_PollEvent(&gEvent) != 0) {
-		// handle user manually closing game window
-		if (gEvent.type == SDL_QUIT) {
-			// pop all state
-			while (!gStageStack.empty()) {
-				gStageStack.pop();
-			}
+	pollInput();
+	InputEvent input;
+	while (gInput.pop(&input)) {
+		if (!input.pressed) {
+			continue;
+		}
+		switch (input.command)
+		{
+		case INPUT_QUIT:
+			quitGame();
 			return;// game is over, exit the function
+		case INPUT_BACK:
+			gStageStack.pop();
+			return;// this state is done, exit the function
+		// Yes
+		case INPUT_YES:
+			gStageStack.pop();
+			return;// game is over, exit the function
+		// No
+		case INPUT_NO:
+			StateStruct temp;
+			temp.StatePointer = Exit;
+			gStageStack.push(temp);
+			temp.StatePointer = Menu;
+			gStageStack.push(temp);
+			return;// this state is done, exit the function
+		default:
+			break;
 		}
-		// handle keyboard input
-		if (gEvent.type == SDL_KEYDOWN) {
-			switch (gEvent.key.keysym.sym)
-			{
-			case SDLK_ESCAPE:
-				gStageStack.pop();
-				return;// this state is done, exit the function
-				break;
-				// Yes
-			case SDLK_y:
-				gStageStack.pop();
-				return;// game is over, exit the function
-				break;
-				// No
-			case SDLK_n:
-				StateStruct temp;
-				temp.StatePointer = Exit;
-				gStageStack.push(temp);
-				temp.StatePointer = Menu;
-				gStageStack.push(temp);
-				return;// this state is done, exit the function
-				break;
-			default:
-				break;
-			}
+	}
+}
+
+// receive input handle it while waiting for the other player
+void handleConnectInput() {
+	pollInput();
+	InputEvent input;
+	while (gInput.pop(&input)) {
+		if (input.command == INPUT_QUIT) {
+			quitGame();
+			return;// game is over, exit the function
+		}
+		if (input.command == INPUT_BACK && input.pressed) {
+			gNet.close();
+			gStageStack.pop();
+			return;// this state is done, exit the function
+		}
+	}
+}
+
+void pollInput() {
+	while (SDL_PollEvent(&gEvent) != 0) {
+		handleWindowEvent();
+		gInput.push(gEvent);
+	}
+}
+
+// handle user manually closing game window
+void quitGame() {
+	// pop all state
+	while (!gStageStack.empty()) {
+		gStageStack.pop();
+	}
+}
+
+// window events shared by every state
+void handleWindowEvent() {
+	if (gEvent.type == SDL_WINDOWEVENT) {
+		switch (gEvent.window.event)
+		{
+		case SDL_WINDOWEVENT_SHOWN:
+		case SDL_WINDOWEVENT_EXPOSED:
+		case SDL_WINDOWEVENT_RESTORED:
+		case SDL_WINDOWEVENT_SIZE_CHANGED:
+		case SDL_WINDOWEVENT_FOCUS_GAINED:
+			// window content may be gone, present the static screen again
+			gScreenCache.invalidate();
+			break;
+		case SDL_WINDOWEVENT_FOCUS_LOST:
+			// key up events go to another window now
+			gPlayerInput.direction = 0;
+			gRewinding = false;
+			break;
+		default:
+			break;
 		}
+	} else if (gEvent.type == SDL_RENDER_TARGETS_RESET || gEvent.type == SDL_RENDER_DEVICE_RESET) {
+		// target texture lost its pixels
+		gScreenCache.reset();
 	}
 }
 
-bool checkWallCollision(Sticky* sticky) {
-	int left = sticky->getStartX();
-	int right = sticky->getStartX() + sticky->getWidth();
-	// check
-	left += sticky->getVelocityX();
-	right += sticky->getVelocityX();
-	if (left < GAME_AREA_LEFT || right > GAME_AREA_RIGHT) {
-		return true;
+bool isWindowActive() {
+	Uint32 flags = SDL_GetWindowFlags(gWindow);
+	if (flags & (SDL_WINDOW_MINIMIZED | SDL_WINDOW_HIDDEN)) {
+		return false;
 	}
-	return false;
+	return (flags & SDL_WINDOW_INPUT_FOCUS) != 0;
 }
 
-bool checkWallCollision(Ball* ball) {
-	int x = ball->getCenterX() + ball->getVelocityX();
-	int y = ball->getCenterY() + ball->getVelocityY();
-	int radius = ball->getRadius();
-	if (x - radius<GAME_AREA_LEFT || x + radius>GAME_AREA_RIGHT || y - radius<GAME_AREA_TOP || y + radius>GAME_AREA_BOTTOM) {
-		return true;
+void waitForWindow() {
+	// block without timeout, only window events can make it active again
+	if (SDL_WaitEvent(&gEvent) != 0) {
+		handleWindowEvent();
+		if (gEvent.type == SDL_QUIT) {
+			quitGame();
+		}
 	}
-	return false;
 }
 
-bool checkEntityCollision(Sticky* sticky, Ball *ball) {
-	// get ball position
-	int ballX = ball->getCenterX()+ball->getVelocityX();
-	int ballY = ball->getCenterY()+ball->getVelocityY();
-	int radius = ball->getRadius();
-	// get closest point to ball on sticky
-	int stickyX = ballX;
-	int stickyY = ballY;
-	int tempX = sticky->getStartX();
-	int tempY = sticky->getStartY();
-	if (ballX < tempX) {
-		stickyX = tempX;
+bool tickGame() {
+	TickInput input = gPlayerInput;
+	// serve once, not on every tick of the frame
+	gPlayerInput.serve = false;
+	if (gPlayback && !gReplay.next(&input)) {
+		// replay is over, quit
+		while (!gStageStack.empty()) {
+			gStageStack.pop();
+		}
+		return false;
 	}
-	if (ballY < tempY) {
-		stickyY = tempY;
+	if (gRecordPath != NULL) {
+		gRecorder.record(input);
 	}
-	tempX += sticky->getWidth();
-	tempY += sticky->getHeight();
-	if (ballX > tempX) {
-		stickyX = tempX;
+	// state before the tick, a copy of plain data
+	GameSnapshot snapshot;
+	snapshot.state = gSim.getState();
+	snapshot.tick = gTick;
+	gRewind.push(snapshot);
+	gTick++;
+	gSim.applyInput(input);
+
+	gLastState = gSim.getState();
+	TickResult result = gSim.step();
+	playSounds(gLastState, gSim.getState());
+	gMultiBall.step(gSim.getState().player, gSim.getState().computer);
+	if (result != TICK_NONE) {
+		// ball is back in the middle, do not draw it flying there
+		gLastState = gSim.getState();
 	}
-	if (ballY > tempY) {
-		stickyY = tempY;
+	if (result == TICK_PLAYER_WIN || result == TICK_COMPUTER_WIN) {
+		// reset, the next game can not rewind into this one
+		gSim.resetScore();
+		gRewind.clear();
+		if (gPlayback) {
+			// the recording goes on with the next match, same as playReplay
+			return true;
+		}
+		// pop all state
+		while (!gStageStack.empty()) {
+			gStageStack.pop();
+		}
+		// game win or lose state
+		StateStruct state;
+		state.StatePointer = result == TICK_PLAYER_WIN ? GameWin : GameLose;
+		gStageStack.push(state);
+		return false;
 	}
+	return true;
+}
 
-	// count distance square
-	tempX = stickyX - ballX;
-	tempY = stickyY - ballY;
-	if (tempX*tempX + tempY*tempY < radius*radius) {
-		return true;
+// party balls are not part of the snapshot, they hold still while rewinding
+// and go on from where they were when play resumes
+bool rewindTick() {
+	GameSnapshot snapshot;
+	if (!gRewind.pop(&snapshot)) {
+		// stuck at the oldest snapshot, draw it still
+		gLastState = gSim.getState();
+		return false;
+	}
+	// drawn positions move from the current state back to the snapshot
+	gLastState = gSim.getState();
+	gSim.getState() = snapshot.state;
+	gTick = snapshot.tick;
+	// recording goes on from the restored tick
+	if (gRecordPath != NULL) {
+		gRecorder.truncate(snapshot.tick);
 	}
-	return false;
+	return true;
+}
+
+bool isNetGame() {
+	return gNetHost || gNetJoin != NULL;
 }
 
-void changeBallSpeed(Ball* ball) {
-	int velX = ball->getVelocityX();
-	int velY = ball->getVelocityY();
-	int x = ball->getCenterX();
-	int y = ball->getCenterY();
-	int radius = ball->getRadius();
-	// change speed when collision with wall
-	if (x - radius < GAME_AREA_LEFT || x + radius > GAME_AREA_RIGHT) {
-		ball->setVelocity(-velX, velY);
+bool openNetwork() {
+	bool success = false;
+	if (gNetHost) {
+		success = gNet.host(gNetPort);
+	} else {
+		// session tells this game from packets of an earlier one
+		success = gNet.join(gNetJoin, gNetPort, (unsigned int)time(0) ^ ((unsigned int)rand() << 8));
+	}
+	gNet.setDelay(gNetDelay);
+	if (!success) {
+		printf("Failed to open network game!\n");
 	}
-	// check game win or lose score
-	if (y + radius < 0) {
-		// computer get score
-		gPlayerScore++;
-		// reset ball and start flag
-		gBall->setCenter(BALL_START_X, BALL_START_Y);
-		gBall->setVelocity(0, 0);
-		gBallSpeed = BALL_INIT_SPEED;
-		gStart = true;
+	return success;
+}
 
-		if (gPlayerScore >= SCORE) {
-			// lose game
-			while (!gStageStack.empty()) {
-				gStageStack.pop();
-			}
-			// reset
-			gComputerScore = 0;
-			gPlayerScore = 0;
-			// game win state
-			StateStruct win;
-			win.StatePointer = GameWin;
-			gStageStack.push(win);
-		}
-	}
-	if (y - radius > WINDOW_HEIGHT) {
-		// player get score
-		gComputerScore++;
-		// reset ball and start flag
-		gBall->setCenter(BALL_START_X, BALL_START_Y);
-		gBall->setVelocity(0, 0);
-		gBallSpeed = BALL_INIT_SPEED;
-		gStart = true;
-
-		if (gComputerScore >= SCORE) {
-			// lose game
-			while (!gStageStack.empty()) {
-				gStageStack.pop();
-			}
-			// reset
-			gComputerScore = 0;
-			gPlayerScore = 0;
-			// game lose state
-			StateStruct lose;
-			lose.StatePointer = GameLose;
-			gStageStack.push(lose);
-		}
-	}
-	// change speed when collision with sticky
-	if (checkEntityCollision(gPlayerSticky, ball)) {
-		if (x < gPlayerSticky->getStartX() || 
-			x > gPlayerSticky->getStartX() + gPlayerSticky->getWidth()) {
-			gBall->setVelocity(-velX, velY);
-		} else {
-			// set speed
-			velY += BALL_CHANGE_SPEED;
-			gBall->setVelocity(gPlayerSticky->getVelocityX() + velX, -velY);
-			// set position
-			gBall->setCenter(x + velX, gPlayerSticky->getStartY() - radius);
+// local input is used at once and remote input is guessed, late remote
+// input that differs from the guess simulates the ticks since then again
+void advanceNetGame(int ticks) {
+	Uint32 now = SDL_GetTicks();
+	if (!gNet.receive(now, &gRollback)) {
+		printf("Lost connection to the other player!\n");
+		gNet.close();
+		gStageStack.pop();
+		return;
+	}
+	gRollback.resimulate();
+	for (int i = 0; i < ticks; i++) {
+		// ahead of the other player, give it a tick to catch up
+		if (gRollback.shouldWait()) {
+			continue;
+		}
+		// too far ahead of the remote input, wait for it
+		if (!gRollback.canAdvance()) {
+			break;
+		}
+		TickInput input = gPlayerInput;
+		// serve once, not on every tick of the frame
+		gPlayerInput.serve = false;
+		gRollback.advance(input);
+	}
+	gNet.send(&gRollback);
+
+	// only a win both players agree on ends the game
+	TickResult result = gRollback.pollConfirmedResult();
+	if (result == TICK_PLAYER_WIN || result == TICK_COMPUTER_WIN) {
+		// the other player may still miss our last inputs
+		for (int i = 1; i < NET_FINAL_SENDS; i++) {
+			gNet.send(&gRollback);
+		}
+		gNet.close();
+		bool localWin = (result == TICK_PLAYER_WIN) == (gRollback.getLocalSide() == SIDE_PLAYER);
+		// pop all state
+		while (!gStageStack.empty()) {
+			gStageStack.pop();
+		}
+		// game win or lose state
+		StateStruct state;
+		state.StatePointer = localWin ? GameWin : GameLose;
+		gStageStack.push(state);
+	}
+}
+
+void playSounds(const SimState& last, const SimState& state) {
+	if (state.playerScore + state.computerScore > last.playerScore + last.computerScore) {
+		gSound.play(SOUND_SCORE);
+	} else if ((last.ball.velocityY < 0) != (state.ball.velocityY < 0) && last.ball.velocityY != 0 && state.ball.velocityY != 0) {
+		// stickies turn the ball around vertically
+		gSound.play(SOUND_HIT);
+	} else if ((last.ball.velocityX < 0) != (state.ball.velocityX < 0) && last.ball.velocityX != 0 && state.ball.velocityX != 0) {
+		gSound.play(SOUND_WALL);
+	}
+}
+
+// subpixel position between two ticks to pixels
+float lerpPixels(int from, int to, float alpha) {
+	return (from + (to - from) * alpha) / SUBPIXELS;
+}
+
+// place drawable entities between the last two simulation states
+// alpha is the elapsed part of the next tick
+void syncEntities(const SimState& last, const SimState& state, float alpha) {
+	const float scale = 1.0f / SUBPIXELS;
+	gBall.setCenter(lerpPixels(last.ball.centerX, state.ball.centerX, alpha), lerpPixels(last.ball.centerY, state.ball.centerY, alpha));
+	gBall.setVelocity(state.ball.velocityX * scale, state.ball.velocityY * scale);
+	gComputerSticky.setStart(lerpPixels(last.computer.startX, state.computer.startX, alpha), lerpPixels(last.computer.startY, state.computer.startY, alpha));
+	gComputerSticky.setVelocity(state.computer.velocityX * scale, state.computer.velocityY * scale);
+	gPlayerSticky.setStart(lerpPixels(last.player.startX, state.player.startX, alpha), lerpPixels(last.player.startY, state.player.startY, alpha));
+	gPlayerSticky.setVelocity(state.player.velocityX * scale, state.player.velocityY * scale);
+}
 
+// rebuild score line only when a score changed
+void updateScoreText(const SimState& state) {
+	if (state.playerScore != gShownPlayerScore || state.computerScore != gShownComputerScore) {
+		gShownPlayerScore = state.playerScore;
+		gShownComputerScore = state.computerScore;
+		char scoreText[64];
+		snprintf(scoreText, sizeof(scoreText), "Player Score: %d   Computer Score: %d", gShownPlayerScore, gShownComputerScore);
+		gScoreText.setText(&gTextAtlas, scoreText, 0, 0, gTextColor);
+	}
+}
+
+// recent frame timing under the score line
+void drawProfilerOverlay() {
+	if (!gShowProfiler) {
+		return;
+	}
+	// refresh the numbers a few times a second
+	if (gProfilerRefresh-- <= 0) {
+		gProfilerRefresh = PROFILER_REFRESH_FRAMES;
+		int lineHeight = gTextAtlas.getLineHeight();
+		for (int i = 0; i < PHASE_COUNT; i++) {
+			PhaseStats stats = gProfiler.getRecentStats((FramePhase)i);
+			char line[96];
+			snprintf(line, sizeof(line), "%-10s p50 %6.2f  p99 %6.2f  max %6.2f ms", FRAME_PHASE_NAMES[i], stats.p50, stats.p99, stats.max);
+			gProfilerText[i].setText(&gTextAtlas, line, 0, GAME_AREA_TOP + i * lineHeight, gTextColor);
+		}
+		// key press to the frame showing it on screen
+		PhaseStats latency = gProfiler.getRecentLatency();
+		char line[96];
+		snprintf(line, sizeof(line), "%-10s p50 %6.2f  p99 %6.2f  max %6.2f ms", "latency", latency.p50, latency.p99, latency.max);
+		gProfilerText[PHASE_COUNT].setText(&gTextAtlas, line, 0, GAME_AREA_TOP + PHASE_COUNT * lineHeight, gTextColor);
+		// heap allocations, none are expected once the game runs
+		if (gProfiler.isCountingAllocations()) {
+			AllocCount frame = gProfiler.getFrameAllocations();
+			AllocCount steady = gProfiler.getSteadyAllocations();
+			snprintf(line, sizeof(line), "%-10s %lld last frame  %lld since warm-up", "heap", frame.allocations, steady.allocations);
+			gProfilerText[PHASE_COUNT + 1].setText(&gTextAtlas, line, 0, GAME_AREA_TOP + (PHASE_COUNT + 1) * lineHeight, gTextColor);
 		}
 	}
-	if (checkEntityCollision(gComputerSticky, ball)) {
-		if (x < gComputerSticky->getStartX() ||
-			x > gComputerSticky->getStartX() + gComputerSticky->getWidth()) {
-			gBall->setVelocity(-velX, velY);
-		} else {
-			velY -= BALL_CHANGE_SPEED;
-			gBall->setVelocity(gComputerSticky->getVelocityX() + velX, -velY);
-			// set position
-			gBall->setCenter(x + velX, gComputerSticky->getStartY() + gComputerSticky->getHeight() + radius);
+	for (int i = 0; i < PHASE_COUNT + 2; i++) {
+		gProfilerText[i].render(gRenderer);
+	}
+}
+
+void syncGpu() {
+	// reading a pixel back cannot finish before every queued draw did
+	Uint32 pixel = 0;
+	SDL_Rect rect = { 0, 0, 1, 1 };
+	SDL_RenderReadPixels(gRenderer, &rect, SDL_PIXELFORMAT_ARGB8888, &pixel, sizeof(pixel));
+}
+
+// Pong [--vsync] [--low-latency] [--frame-queue N] [--present-asap] [--fps N] [--skill name] [--multiball N] [--host | --join address] [--port N] [--net-delay ms] [--profile] [--profile-csv file] [--alloc-report [--alloc-break]] [--assets dir] [--mute] [--capture dir [--capture-png] [--capture-fps N]] [--record file] [--replay file [--fast] [--repeat N]]
+void parseOptions(int argc, char** argv) {
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--vsync") == 0) {
+			gVsync = true;
+		} else if (strcmp(argv[i], "--low-latency") == 0) {
+			gLowLatency = true;
+			gFrameQueue = 1;
+		} else if (strcmp(argv[i], "--frame-queue") == 0 && i + 1 < argc) {
+			gFrameQueue = atoi(argv[++i]);
+		} else if (strcmp(argv[i], "--present-asap") == 0) {
+			gPresentAsap = true;
+		} else if (strcmp(argv[i], "--fps") == 0 && i + 1 < argc) {
+			gFramesPerSecond = atoi(argv[++i]);
+		} else if (strcmp(argv[i], "--skill") == 0 && i + 1 < argc) {
+			const char* name = argv[++i];
+			for (int skill = 0; skill < SKILL_COUNT; skill++) {
+				if (strcmp(name, SKILL_NAMES[skill]) == 0) {
+					gComputerSkill = (ComputerSkill)skill;
+				}
+			}
+		} else if (strcmp(argv[i], "--multiball") == 0 && i + 1 < argc) {
+			gMultiBallCount = atoi(argv[++i]);
+		} else if (strcmp(argv[i], "--host") == 0) {
+			gNetHost = true;
+		} else if (strcmp(argv[i], "--join") == 0 && i + 1 < argc) {
+			gNetJoin = argv[++i];
+		} else if (strcmp(argv[i], "--port") == 0 && i + 1 < argc) {
+			gNetPort = atoi(argv[++i]);
+		} else if (strcmp(argv[i], "--net-delay") == 0 && i + 1 < argc) {
+			gNetDelay = atoi(argv[++i]);
+		} else if (strcmp(argv[i], "--profile") == 0) {
+			gShowProfiler = true;
+		} else if (strcmp(argv[i], "--profile-csv") == 0 && i + 1 < argc) {
+			gProfileCsv = argv[++i];
+		} else if (strcmp(argv[i], "--alloc-report") == 0) {
+			gAllocReport = true;
+		} else if (strcmp(argv[i], "--alloc-break") == 0) {
+			gAllocReport = true;
+			gAllocBreak = true;
+		} else if (strcmp(argv[i], "--mute") == 0) {
+			gMute = true;
+		} else if (strcmp(argv[i], "--assets") == 0 && i + 1 < argc) {
+			gAssetDir = argv[++i];
+		} else if (strcmp(argv[i], "--capture") == 0 && i + 1 < argc) {
+			gCapturePath = argv[++i];
+		} else if (strcmp(argv[i], "--capture-png") == 0) {
+			gCaptureFormat = CAPTURE_PNG;
+		} else if (strcmp(argv[i], "--capture-fps") == 0 && i + 1 < argc) {
+			gCaptureFps = atoi(argv[++i]);
+		} else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+			gRecordPath = argv[++i];
+		} else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+			gReplayPath = argv[++i];
+		} else if (strcmp(argv[i], "--fast") == 0) {
+			gFastReplay = true;
+		} else if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+			gReplayRepeat = atoi(argv[++i]);
 		}
 	}
 }
 
-void changeComputerStickySpeed() {
-	if (gBall->getVelocityY() < 0 && 
-		gBall->getCenterY()>gComputerSticky->getStartY()+gComputerSticky->getHeight()) {
-		// count computer sticky left and right
-		int left = gComputerSticky->getStartX();
-		int right = gComputerSticky->getStartX() + gComputerSticky->getWidth();
-		// get ball center x
-		int ballX = gBall->getCenterX();
-		if (ballX <= left) {
-			gComputerSticky->setVelocity(-STICKY_SPEED, 0);
+// Pong --headless --matches N [--seed S]
+bool parseHeadless(int argc, char** argv, int* matches, unsigned int* seed) {
+	bool headless = false;
+	*matches = 1;
+	*seed = (unsigned int)time(0);
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--headless") == 0) {
+			headless = true;
+		} else if (strcmp(argv[i], "--matches") == 0 && i + 1 < argc) {
+			*matches = atoi(argv[++i]);
+		} else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+			*seed = (unsigned int)strtoul(argv[++i], NULL, 10);
 		}
-		else if (ballX >= right) {
-			gComputerSticky->setVelocity(STICKY_SPEED, 0);
-		} else {
-			gComputerSticky->setVelocity(0, 0);
+	}
+	return headless;
+}
+
+// computer vs computer matches as fast as possible
+void runHeadless(int matches, unsigned int seed) {
+	Simulation sim;
+	int playerWins = 0;
+	int computerWins = 0;
+	long long ticks = 0;
+	clock_t begin = clock();
+	for (int i = 0; i < matches; i++) {
+		MatchStats stats = playMatch(sim, seed + i);
+		if (stats.playerScore >= SCORE) {
+			playerWins++;
+		} else if (stats.computerScore >= SCORE) {
+			computerWins++;
 		}
-	} else {
-		gComputerSticky->setVelocity(0, 0);
+		ticks += stats.ticks;
+	}
+	double seconds = (double)(clock() - begin) / CLOCKS_PER_SEC;
+	printf("matches: %d, player wins: %d, computer wins: %d, unfinished: %d\n", matches, playerWins, computerWins, matches - playerWins - computerWins);
+	printf("ticks: %lld, seconds: %.3f, ticks per second: %.0f\n", ticks, seconds, seconds > 0 ? ticks / seconds : 0.0);
+}
+
+// replay without window, unthrottled
+void runReplay() {
+	Simulation sim;
+	srand(gReplay.getSeed());
+	ReplayStats stats;
+	memset(&stats, 0, sizeof(stats));
+	long long ticks = 0;
+	clock_t begin = clock();
+	for (int i = 0; i < gReplayRepeat; i++) {
+		stats = playReplay(sim, gReplay);
+		ticks += stats.ticks;
 	}
+	double seconds = (double)(clock() - begin) / CLOCKS_PER_SEC;
+	printf("replay ticks: %lld, player wins: %d, computer wins: %d, final score: %d - %d\n", stats.ticks, stats.playerWins, stats.computerWins, stats.playerScore, stats.computerScore);
+	printf("passes: %d, seconds: %.3f, ticks per second: %.0f\n", gReplayRepeat, seconds, seconds > 0 ? ticks / seconds : 0.0);
 }
\ No newline at end of file
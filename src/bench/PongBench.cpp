@@ -0,0 +1,559 @@
+//////////////////////////////////////////////////////////////////////////////////
+// Project: Pong
+// File:    PongBench.cpp
+//////////////////////////////////////////////////////////////////////////////////
+
+// links
+#pragma comment(lib, "SDL2.lib")
+#pragma comment(lib, "SDL2main.lib")
+#pragma comment(lib, "SDL2_ttf.lib")
+#pragma comment(lib, "SDL2_image.lib")
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "../../include/Constants.h"
+#include "../../include/Tools.h"
+#include "../../include/TextAtlas.h"
+#include "../../include/SpriteBatch.h"
+#include "../../include/Ball.h"
+#include "../../include/Sticky.h"
+#include "../../include/Simulation.h"
+#include "../../include/BatchWorld.h"
+#include "../../include/MultiBall.h"
+#include "../../include/AssetBundle.h"
+
+// states the collision benchmarks cycle through, a power of two
+const int BENCH_SAMPLES = 1024;
+// matches stepped together by the batch benchmark
+const int BENCH_BATCH = 1024;
+// party balls of the multi-ball benchmark
+const int BENCH_MULTIBALL = 10000;
+// simulation ticks between two rendered frames, the game at 60 frames per second
+const int BENCH_TICKS_PER_FRAME = TICKS_PER_SECOND / FRAMES_PER_SECOND;
+// text of the rendered text benchmark, as long as the score line
+const char* const BENCH_TEXT = "Player Score: 3   Computer Score: 4";
+
+// PongBench [--time seconds] [--out file] [--driver name]
+struct BenchSettings
+{
+	// every benchmark runs at least this long
+	double seconds;
+	// json results
+	const char* out;
+	// SDL video driver of the render benchmarks
+	const char* driver;
+};
+
+// one measured benchmark
+struct BenchResult
+{
+	std::string name;
+	// what one operation is
+	const char* unit;
+	long long operations;
+	double seconds;
+};
+
+// runs the measured code about iterations times, returns how many operations it did
+typedef long long(*BenchBody)(void* context, long long iterations);
+
+// results of the collision helpers, kept so the calls are not optimized away
+volatile int gSink = 0;
+
+bool parseOptions(int argc, char** argv, BenchSettings* settings);
+
+// grow the iterations until one run takes settings.seconds, keep that run
+void runBench(const BenchSettings& settings, const char* name, const char* unit, BenchBody body, void* context, std::vector<BenchResult>* results);
+
+// headless game logic
+void runSimulationBenches(const BenchSettings& settings, std::vector<BenchResult>* results);
+
+// text and whole frames through SDL without a visible window, false when SDL is not usable
+bool runRenderBenches(const BenchSettings& settings, std::vector<BenchResult>* results, std::string* driver, std::string* renderer);
+
+void printResults(const std::vector<BenchResult>& results);
+bool writeJson(const char* path, const BenchSettings& settings, const std::vector<BenchResult>& results, const std::string& driver, const std::string& renderer);
+
+int main(int argc, char** argv) {
+	BenchSettings settings;
+	if (!parseOptions(argc, argv, &settings)) {
+		return 1;
+	}
+
+	std::vector<BenchResult> results;
+	runSimulationBenches(settings, &results);
+	std::string driver;
+	std::string renderer;
+	if (!runRenderBenches(settings, &results, &driver, &renderer)) {
+		printf("Render benchmarks skipped!\n");
+	}
+
+	printResults(results);
+	if (!writeJson(settings.out, settings, results, driver, renderer)) {
+		printf("Unable to write %s!\n", settings.out);
+		return 1;
+	}
+	return 0;
+}
+
+bool parseOptions(int argc, char** argv, BenchSettings* settings) {
+	settings->seconds = 0.5;
+	settings->out = "pong_bench.json";
+	settings->driver = "dummy";
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--time") == 0 && i + 1 < argc) {
+			settings->seconds = atof(argv[++i]);
+		} else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+			settings->out = argv[++i];
+		} else if (strcmp(argv[i], "--driver") == 0 && i + 1 < argc) {
+			settings->driver = argv[++i];
+		} else {
+			printf("Unknown option %s!\n", argv[i]);
+			printf("PongBench [--time seconds] [--out file] [--driver name]\n");
+			return false;
+		}
+	}
+	if (settings->seconds <= 0) {
+		printf("Benchmark time has to be positive!\n");
+		return false;
+	}
+	return true;
+}
+
+void runBench(const BenchSettings& settings, const char* name, const char* unit, BenchBody body, void* context, std::vector<BenchResult>* results) {
+	// warm caches and branch predictors before timing
+	body(context, 1);
+	long long iterations = 1;
+	while (true) {
+		std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+		long long operations = body(context, iterations);
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+		if (seconds >= settings.seconds) {
+			BenchResult result;
+			result.name = name;
+			result.unit = unit;
+			result.operations = operations;
+			result.seconds = seconds;
+			results->push_back(result);
+			return;
+		}
+		// aim a little past the time, but never more than ten times the last run
+		double scale = seconds > 0 ? settings.seconds * 1.2 / seconds : 10.0;
+		scale = scale < 2.0 ? 2.0 : (scale > 10.0 ? 10.0 : scale);
+		iterations = (long long)(iterations * scale);
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////////////
+// simulation
+
+// balls and stickies around the player row, so both collision outcomes are common
+struct CollisionBench
+{
+	BallState balls[BENCH_SAMPLES];
+	StickyState stickies[BENCH_SAMPLES];
+};
+
+// a game played computer against computer
+struct SimulationBench
+{
+	Simulation sim;
+	unsigned int seed;
+};
+
+// a game with party balls around the match ball
+struct MultiBallBench
+{
+	SimulationBench game;
+	MultiBallWorld world;
+};
+
+// random number in [0, range), same lcg as the serves
+static int nextBenchRandom(unsigned int* seed, int range) {
+	*seed = *seed * 1103515245u + 12345u;
+	return (int)((*seed >> 8) % (unsigned int)range);
+}
+
+static void initCollisionBench(CollisionBench* bench) {
+	unsigned int seed = 1;
+	int radius = toSubpixels(BALL_RADIUS);
+	for (int i = 0; i < BENCH_SAMPLES; i++) {
+		BallState& ball = bench->balls[i];
+		ball.radius = radius;
+		ball.centerX = nextBenchRandom(&seed, toSubpixels(WINDOW_WIDTH));
+		ball.centerY = toSubpixels(PLAYER_START_Y) - 2 * radius + nextBenchRandom(&seed, toSubpixels(STICKY_HEIGHT) + 4 * radius);
+		ball.velocityX = nextBenchRandom(&seed, 2 * BALL_MAX_VELOCITY + 1) - BALL_MAX_VELOCITY;
+		ball.velocityY = nextBenchRandom(&seed, 2 * BALL_MAX_VELOCITY + 1) - BALL_MAX_VELOCITY;
+		StickyState& sticky = bench->stickies[i];
+		sticky.width = toSubpixels(STICKY_WIDTH);
+		sticky.height = toSubpixels(STICKY_HEIGHT);
+		sticky.startX = nextBenchRandom(&seed, toSubpixels(WINDOW_WIDTH));
+		sticky.startY = toSubpixels(PLAYER_START_Y);
+		sticky.velocityX = (nextBenchRandom(&seed, 3) - 1) * STICKY_VELOCITY;
+		sticky.velocityY = 0;
+	}
+}
+
+static void initSimulationBench(SimulationBench* bench) {
+	bench->seed = 1;
+	bench->sim.setComputerSkill(SKILL_NORMAL);
+	bench->sim.reset();
+}
+
+static long long benchEntityCollision(void* context, long long iterations) {
+	CollisionBench* bench = (CollisionBench*)context;
+	int hits = 0;
+	for (long long i = 0; i < iterations; i++) {
+		int sample = (int)(i & (BENCH_SAMPLES - 1));
+		hits += checkEntityCollision(bench->stickies[sample], bench->balls[sample]);
+	}
+	gSink = gSink + hits;
+	return iterations;
+}
+
+static long long benchBallWallCollision(void* context, long long iterations) {
+	CollisionBench* bench = (CollisionBench*)context;
+	int hits = 0;
+	for (long long i = 0; i < iterations; i++) {
+		hits += checkWallCollision(bench->balls[i & (BENCH_SAMPLES - 1)]);
+	}
+	gSink = gSink + hits;
+	return iterations;
+}
+
+static long long benchStickyWallCollision(void* context, long long iterations) {
+	CollisionBench* bench = (CollisionBench*)context;
+	int hits = 0;
+	for (long long i = 0; i < iterations; i++) {
+		hits += checkWallCollision(bench->stickies[i & (BENCH_SAMPLES - 1)]);
+	}
+	gSink = gSink + hits;
+	return iterations;
+}
+
+// only the ball moves, stickies stand where they are
+static long long benchChangeBallSpeed(void* context, long long iterations) {
+	SimulationBench* bench = (SimulationBench*)context;
+	Simulation& sim = bench->sim;
+	for (long long i = 0; i < iterations; i++) {
+		if (sim.getState().start) {
+			sim.serve(nextServeVelocity(&bench->seed));
+		}
+		TickResult result = sim.changeBallSpeed();
+		if (result == TICK_PLAYER_WIN || result == TICK_COMPUTER_WIN) {
+			sim.resetScore();
+		}
+	}
+	return iterations;
+}
+
+// a whole tick of playMatch, both stickies played by the computer
+static long long benchSimulationTick(void* context, long long iterations) {
+	SimulationBench* bench = (SimulationBench*)context;
+	Simulation& sim = bench->sim;
+	for (long long i = 0; i < iterations; i++) {
+		if (sim.getState().start) {
+			sim.serve(nextServeVelocity(&bench->seed));
+		}
+		sim.changePlayerStickySpeed();
+		TickResult result = sim.step();
+		if (result == TICK_PLAYER_WIN || result == TICK_COMPUTER_WIN) {
+			sim.reset();
+		}
+	}
+	return iterations;
+}
+
+// one operation is one match tick, the world steps all of its matches at once
+static long long benchBatchTick(void* context, long long iterations) {
+	BatchWorld* world = (BatchWorld*)context;
+	long long steps = (iterations + world->getCount() - 1) / world->getCount();
+	for (long long i = 0; i < steps; i++) {
+		world->step();
+	}
+	return steps * world->getCount();
+}
+
+// a match tick with the party balls around it, one operation is the whole tick
+static long long benchMultiBallTick(void* context, long long iterations) {
+	MultiBallBench* bench = (MultiBallBench*)context;
+	Simulation& sim = bench->game.sim;
+	for (long long i = 0; i < iterations; i++) {
+		if (sim.getState().start) {
+			sim.serve(nextServeVelocity(&bench->game.seed));
+		}
+		sim.changePlayerStickySpeed();
+		TickResult result = sim.step();
+		if (result == TICK_PLAYER_WIN || result == TICK_COMPUTER_WIN) {
+			sim.reset();
+		}
+		bench->world.step(sim.getState().player, sim.getState().computer);
+	}
+	return iterations;
+}
+
+void runSimulationBenches(const BenchSettings& settings, std::vector<BenchResult>* results) {
+	CollisionBench* collision = new CollisionBench();
+	initCollisionBench(collision);
+	runBench(settings, "checkEntityCollision", "call", benchEntityCollision, collision, results);
+	runBench(settings, "checkWallCollision_ball", "call", benchBallWallCollision, collision, results);
+	runBench(settings, "checkWallCollision_sticky", "call", benchStickyWallCollision, collision, results);
+	delete collision;
+
+	SimulationBench simulation;
+	initSimulationBench(&simulation);
+	runBench(settings, "changeBallSpeed", "call", benchChangeBallSpeed, &simulation, results);
+	initSimulationBench(&simulation);
+	runBench(settings, "simulation_tick", "tick", benchSimulationTick, &simulation, results);
+
+	MultiBallBench* multiBall = new MultiBallBench();
+	initSimulationBench(&multiBall->game);
+	multiBall->world.reset(BENCH_MULTIBALL, 1);
+	runBench(settings, "multiball_tick", "tick", benchMultiBallTick, multiBall, results);
+	delete multiBall;
+
+	BatchWorld world(BENCH_BATCH, 1);
+	runBench(settings, "batch_tick", "tick", benchBatchTick, &world, results);
+}
+
+//////////////////////////////////////////////////////////////////////////////////
+// rendering
+
+// everything a frame of the game draws, loaded like loadMedia does
+struct RenderBench
+{
+	SDL_Window* window;
+	SDL_Renderer* renderer;
+	AssetBundle assets;
+	LTexture sprite;
+	SpriteAtlas spriteAtlas;
+	TextAtlas textAtlas;
+	SpriteBatch spriteBatch;
+	TextLine scoreText;
+	int shownPlayerScore;
+	int shownComputerScore;
+	// texture of the rendered text benchmark
+	LTexture text;
+	Ball* ball;
+	Sticky* computerSticky;
+	Sticky* playerSticky;
+	SimulationBench game;
+};
+
+static SDL_Color gBenchTextColor = { 0xFF, 0xFF, 0xFF, 0xFF };
+
+static bool loadRenderBench(RenderBench* bench) {
+	std::string bundlePath = BUNDLE_FILE_NAME;
+	char* basePath = SDL_GetBasePath();
+	if (basePath != NULL) {
+		bundlePath = std::string(basePath) + BUNDLE_FILE_NAME;
+		SDL_free(basePath);
+	}
+	if (!bench->assets.open(bundlePath)) {
+		printf("Failed to open asset bundle!\n");
+		return false;
+	}
+
+	const BundleEntry* font = bench->assets.find(BUNDLE_FONT);
+	if (font == NULL || !bench->textAtlas.loadFromMemory(bench->renderer, bench->assets.getData(font), font->size, 12)) {
+		printf("Failed to load font atlas!\n");
+		return false;
+	}
+	// the bundle stays mapped while the font reads from it
+	bench->text.setFont(bench->assets.getData(font), font->size, 12);
+	if (!bench->text.loadFromRenderedText(bench->renderer, BENCH_TEXT, gBenchTextColor)) {
+		printf("Failed to render text!\n");
+		return false;
+	}
+
+	const BundleEntry* sprite = bench->assets.find(BUNDLE_SPRITE);
+	if (sprite == NULL || !bench->sprite.loadFromPixels(bench->renderer, bench->assets.getData(sprite), sprite->width, sprite->height)) {
+		printf("Failed to load background image!\n");
+		return false;
+	}
+	const BundleEntry* atlas = bench->assets.find(BUNDLE_SPRITE_ATLAS);
+	if (atlas == NULL || !bench->spriteAtlas.loadFromMemory((const char*)bench->assets.getData(atlas), atlas->size)) {
+		printf("Failed to load sprite atlas!\n");
+		return false;
+	}
+	const SDL_Rect* computerClip = bench->spriteAtlas.getFrame(SPRITE_COMPUTER_STICKY);
+	const SDL_Rect* playerClip = bench->spriteAtlas.getFrame(SPRITE_PLAYER_STICKY);
+	const SDL_Rect* ballClip = bench->spriteAtlas.getFrame(SPRITE_BALL);
+	if (computerClip == NULL || playerClip == NULL || ballClip == NULL) {
+		return false;
+	}
+	bench->ball = new Ball(BALL_START_X, BALL_START_Y, ballClip);
+	bench->computerSticky = new Sticky(COMPUTER_START_X, COMPUTER_START_Y, computerClip);
+	bench->playerSticky = new Sticky(PLAYER_START_X, PLAYER_START_Y, playerClip);
+	bench->shownPlayerScore = -1;
+	bench->shownComputerScore = -1;
+	initSimulationBench(&bench->game);
+	return true;
+}
+
+static void freeRenderBench(RenderBench* bench) {
+	delete bench->ball;
+	delete bench->computerSticky;
+	delete bench->playerSticky;
+	bench->ball = NULL;
+	bench->computerSticky = NULL;
+	bench->playerSticky = NULL;
+	bench->text.freeTexture();
+	bench->textAtlas.freeAtlas();
+	bench->sprite.freeTexture();
+	bench->assets.close();
+}
+
+static long long benchRenderedText(void* context, long long iterations) {
+	RenderBench* bench = (RenderBench*)context;
+	for (long long i = 0; i < iterations; i++) {
+		bench->text.loadFromRenderedText(bench->renderer, BENCH_TEXT, gBenchTextColor);
+	}
+	return iterations;
+}
+
+// what Game() does in a frame, without input and pacing
+static long long benchFrame(void* context, long long iterations) {
+	RenderBench* bench = (RenderBench*)context;
+	Simulation& sim = bench->game.sim;
+	for (long long i = 0; i < iterations; i++) {
+		for (int tick = 0; tick < BENCH_TICKS_PER_FRAME; tick++) {
+			if (sim.getState().start) {
+				sim.serve(nextServeVelocity(&bench->game.seed));
+			}
+			sim.changePlayerStickySpeed();
+			TickResult result = sim.step();
+			if (result == TICK_PLAYER_WIN || result == TICK_COMPUTER_WIN) {
+				sim.reset();
+			}
+		}
+		const SimState& state = sim.getState();
+		bench->ball->setCenter((float)state.ball.centerX / SUBPIXELS, (float)state.ball.centerY / SUBPIXELS);
+		bench->computerSticky->setStart((float)state.computer.startX / SUBPIXELS, (float)state.computer.startY / SUBPIXELS);
+		bench->playerSticky->setStart((float)state.player.startX / SUBPIXELS, (float)state.player.startY / SUBPIXELS);
+
+		SDL_SetRenderDrawColor(bench->renderer, 0, 0, 0, 0xFF);
+		SDL_RenderClear(bench->renderer);
+		bench->spriteBatch.begin(&bench->sprite);
+		bench->computerSticky->draw(&bench->spriteBatch);
+		bench->playerSticky->draw(&bench->spriteBatch);
+		bench->ball->draw(&bench->spriteBatch);
+		bench->spriteBatch.flush(bench->renderer);
+		if (state.playerScore != bench->shownPlayerScore || state.computerScore != bench->shownComputerScore) {
+			bench->shownPlayerScore = state.playerScore;
+			bench->shownComputerScore = state.computerScore;
+			char scoreText[64];
+			snprintf(scoreText, sizeof(scoreText), "Player Score: %d   Computer Score: %d", state.playerScore, state.computerScore);
+			bench->scoreText.setText(&bench->textAtlas, scoreText, 0, 0, gBenchTextColor);
+		}
+		bench->scoreText.render(bench->renderer);
+		SDL_RenderPresent(bench->renderer);
+	}
+	return iterations;
+}
+
+bool runRenderBenches(const BenchSettings& settings, std::vector<BenchResult>* results, std::string* driver, std::string* renderer) {
+	// no window on screen, a SDL_VIDEODRIVER set in the environment still wins
+	SDL_setenv("SDL_VIDEODRIVER", settings.driver, 0);
+	if (SDL_Init(SDL_INIT_VIDEO) < 0) {
+		printf("SDL could not initialize! SDL Error: %s\n", SDL_GetError());
+		return false;
+	}
+	if (TTF_Init() == -1) {
+		printf("SDL_ttf could not initialize! SDL_ttf Error: %s\n", TTF_GetError());
+		SDL_Quit();
+		return false;
+	}
+
+	bool success = false;
+	RenderBench* bench = new RenderBench();
+	bench->window = SDL_CreateWindow(WINDOW_CAPTION, SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, WINDOW_WIDTH, WINDOW_HEIGHT, SDL_WINDOW_HIDDEN);
+	if (bench->window == NULL) {
+		printf("Window could not be created! SDL Error: %s\n", SDL_GetError());
+	} else {
+		// best renderer the driver has, the software one on dummy, no vsync so frames are not paced
+		bench->renderer = SDL_CreateRenderer(bench->window, -1, 0);
+		if (bench->renderer == NULL) {
+			printf("Renderer could not be created! SDL Error: %s\n", SDL_GetError());
+		} else {
+			*driver = SDL_GetCurrentVideoDriver();
+			SDL_RendererInfo info;
+			if (SDL_GetRendererInfo(bench->renderer, &info) == 0) {
+				*renderer = info.name;
+			}
+			if (loadRenderBench(bench)) {
+				runBench(settings, "loadFromRenderedText", "call", benchRenderedText, bench, results);
+				runBench(settings, "frame", "frame", benchFrame, bench, results);
+				success = true;
+			}
+			freeRenderBench(bench);
+			SDL_DestroyRenderer(bench->renderer);
+		}
+		SDL_DestroyWindow(bench->window);
+	}
+	delete bench;
+
+	TTF_Quit();
+	SDL_Quit();
+	return success;
+}
+
+//////////////////////////////////////////////////////////////////////////////////
+// results
+
+void printResults(const std::vector<BenchResult>& results) {
+	printf("%-28s %14s %16s %16s\n", "benchmark", "operations", "ns per op", "ops per second");
+	for (size_t i = 0; i < results.size(); i++) {
+		const BenchResult& result = results[i];
+		printf("%-28s %14lld %16.2f %16.0f\n", result.name.c_str(), result.operations,
+			result.seconds * 1e9 / result.operations, result.operations / result.seconds);
+	}
+}
+
+// names come from the command line or SDL, quote what json needs quoted
+static void writeJsonString(FILE* file, const std::string& text) {
+	fputc('"', file);
+	for (size_t i = 0; i < text.size(); i++) {
+		char c = text[i];
+		if (c == '"' || c == '\\') {
+			fputc('\\', file);
+			fputc(c, file);
+		} else if ((unsigned char)c < 0x20) {
+			fprintf(file, "\\u%04x", c);
+		} else {
+			fputc(c, file);
+		}
+	}
+	fputc('"', file);
+}
+
+bool writeJson(const char* path, const BenchSettings& settings, const std::vector<BenchResult>& results, const std::string& driver, const std::string& renderer) {
+	FILE* file = fopen(path, "w");
+	if (file == NULL) {
+		return false;
+	}
+	fprintf(file, "{\n");
+	fprintf(file, "\t\"min_seconds\": %.3f,\n", settings.seconds);
+	fprintf(file, "\t\"video_driver\": ");
+	writeJsonString(file, driver);
+	fprintf(file, ",\n\t\"renderer\": ");
+	writeJsonString(file, renderer);
+	fprintf(file, ",\n\t\"benchmarks\": [\n");
+	for (size_t i = 0; i < results.size(); i++) {
+		const BenchResult& result = results[i];
+		fprintf(file, "\t\t{ \"name\": ");
+		writeJsonString(file, result.name);
+		fprintf(file, ", \"unit\": \"%s\", \"operations\": %lld, \"seconds\": %.6f, \"ns_per_op\": %.3f, \"ops_per_second\": %.1f }%s\n",
+			result.unit, result.operations, result.seconds, result.seconds * 1e9 / result.operations,
+			result.operations / result.seconds, i + 1 < results.size() ? "," : "");
+	}
+	fprintf(file, "\t]\n}\n");
+	bool success = ferror(file) == 0;
+	fclose(file);
+	return success;
+}
@@ -0,0 +1,199 @@
+//////////////////////////////////////////////////////////////////////////////////
+// Project: Pong
+// File:    PongEnv.cpp
+//////////////////////////////////////////////////////////////////////////////////
+
+#include <cstring>
+#include <new>
+
+#include "../../include/PongEnv.h"
+#include "../../include/BatchWorld.h"
+#include "../../include/Raster.h"
+
+struct PongEnv
+{
+	PongEnv(int count, unsigned int seed, int ticksPerStep) :
+		world(count, seed), ticksPerStep(ticksPerStep),
+		observations(NULL), rewards(NULL), dones(NULL),
+		raster(NULL), pixels(NULL), stack(0), finished(new unsigned char[count]) {
+	}
+
+	~PongEnv() {
+		delete raster;
+		delete[] finished;
+	}
+
+	BatchWorld world;
+	int ticksPerStep;
+	// caller buffers
+	float* observations;
+	float* rewards;
+	unsigned char* dones;
+	// pixel observations, raster is NULL when they are off
+	Rasterizer* raster;
+	unsigned char* pixels;
+	int stack;
+	// matches that reached SCORE during the last step
+	unsigned char* finished;
+};
+
+// scale from simulation units to observation units
+const float OBSERVATION_SCALE_X = 1.0f / (WINDOW_WIDTH * SUBPIXELS);
+const float OBSERVATION_SCALE_Y = 1.0f / (WINDOW_HEIGHT * SUBPIXELS);
+const float OBSERVATION_SCALE_VELOCITY = 1.0f / BALL_MAX_VELOCITY;
+
+// state arrays of the world to the interleaved observation buffer
+static void writeObservations(const BatchWorld& world, float* __restrict out) {
+	int n = world.getCount();
+	const int* __restrict ballX = world.getBallX();
+	const int* __restrict ballY = world.getBallY();
+	const int* __restrict ballVelX = world.getBallVelocityX();
+	const int* __restrict ballVelY = world.getBallVelocityY();
+	const int* __restrict playerX = world.getPlayerX();
+	const int* __restrict computerX = world.getComputerX();
+	for (int i = 0; i < n; i++) {
+		float* o = out + i * PONG_ENV_OBSERVATION_SIZE;
+		o[0] = ballX[i] * OBSERVATION_SCALE_X;
+		o[1] = ballY[i] * OBSERVATION_SCALE_Y;
+		o[2] = ballVelX[i] * OBSERVATION_SCALE_VELOCITY;
+		o[3] = ballVelY[i] * OBSERVATION_SCALE_VELOCITY;
+		o[4] = playerX[i] * OBSERVATION_SCALE_X;
+		o[5] = computerX[i] * OBSERVATION_SCALE_X;
+	}
+}
+
+// newest frame of every match into the last stack slot, older frames move one slot down
+// matches that started over, or every match on restart, fill the whole stack with it
+static void writePixels(PongEnv* env, bool restart) {
+	BatchWorld& world = env->world;
+	Rasterizer* raster = env->raster;
+	int n = world.getCount();
+	size_t frame = raster->getFrameSize();
+	size_t stride = frame * env->stack;
+	size_t older = frame * (env->stack - 1);
+	for (int i = 0; i < n; i++) {
+		if (!restart && !env->finished[i] && older > 0) {
+			unsigned char* stack = env->pixels + i * stride;
+			memmove(stack, stack + frame, older);
+		}
+	}
+	raster->drawBatch(world, env->pixels + older, (int)stride);
+	for (int i = 0; i < n; i++) {
+		if (restart || env->finished[i]) {
+			// a new match does not see frames of the old one
+			unsigned char* stack = env->pixels + i * stride;
+			for (int j = 0; j < env->stack - 1; j++) {
+				memcpy(stack + j * frame, stack + older, frame);
+			}
+		}
+	}
+}
+
+PongEnv* pong_env_create(int count, unsigned int seed, int ticksPerStep) {
+	if (count <= 0 || ticksPerStep <= 0) {
+		return NULL;
+	}
+	// no exception may leave through the c interface
+	try {
+		return new PongEnv(count, seed, ticksPerStep);
+	} catch (const std::bad_alloc&) {
+		return NULL;
+	}
+}
+
+void pong_env_destroy(PongEnv* env) {
+	delete env;
+}
+
+int pong_env_count(const PongEnv* env) {
+	return env->world.getCount();
+}
+
+void pong_env_set_buffers(PongEnv* env, float* observations, float* rewards, unsigned char* dones) {
+	env->observations = observations;
+	env->rewards = rewards;
+	env->dones = dones;
+}
+
+int pong_env_set_pixels(PongEnv* env, unsigned char* pixels, int width, int height, int channels, int stack) {
+	delete env->raster;
+	env->raster = NULL;
+	env->pixels = NULL;
+	if (pixels == NULL) {
+		return 1;
+	}
+	if ((channels != RASTER_GRAY && channels != RASTER_RGB) || stack <= 0) {
+		return 0;
+	}
+	try {
+		env->raster = new Rasterizer(width, height, (RasterFormat)channels);
+	} catch (const std::bad_alloc&) {
+		return 0;
+	}
+	if (!env->raster->isValid()) {
+		delete env->raster;
+		env->raster = NULL;
+		return 0;
+	}
+	env->pixels = pixels;
+	env->stack = stack;
+	return 1;
+}
+
+void pong_env_reset(PongEnv* env) {
+	BatchWorld& world = env->world;
+	world.reset();
+	int n = world.getCount();
+	memset(env->finished, 0, n);
+	if (env->rewards != NULL) {
+		for (int i = 0; i < n; i++) {
+			env->rewards[i] = 0.0f;
+		}
+	}
+	if (env->dones != NULL) {
+		memset(env->dones, 0, n);
+	}
+	if (env->observations != NULL) {
+		writeObservations(world, env->observations);
+	}
+	if (env->raster != NULL) {
+		writePixels(env, true);
+	}
+}
+
+void pong_env_step(PongEnv* env, const int* actions) {
+	BatchWorld& world = env->world;
+	int n = world.getCount();
+	float* __restrict rewards = env->rewards;
+	unsigned char* __restrict finished = env->finished;
+	memset(finished, 0, n);
+	if (rewards != NULL) {
+		for (int i = 0; i < n; i++) {
+			rewards[i] = 0.0f;
+		}
+	}
+	const int* __restrict results = world.getResult();
+	for (int tick = 0; tick < env->ticksPerStep; tick++) {
+		world.step(actions);
+		// the world already started finished matches over, only the results are left
+		if (rewards != NULL) {
+			for (int i = 0; i < n; i++) {
+				int player = (results[i] == TICK_PLAYER_SCORE) | (results[i] == TICK_PLAYER_WIN);
+				int computer = (results[i] == TICK_COMPUTER_SCORE) | (results[i] == TICK_COMPUTER_WIN);
+				rewards[i] += (float)(player - computer);
+			}
+		}
+		for (int i = 0; i < n; i++) {
+			finished[i] |= (unsigned char)((results[i] == TICK_PLAYER_WIN) | (results[i] == TICK_COMPUTER_WIN));
+		}
+	}
+	if (env->dones != NULL) {
+		memcpy(env->dones, finished, n);
+	}
+	if (env->observations != NULL) {
+		writeObservations(world, env->observations);
+	}
+	if (env->raster != NULL) {
+		writePixels(env, false);
+	}
+}
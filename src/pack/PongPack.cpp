@@ -0,0 +1,131 @@
+//////////////////////////////////////////////////////////////////////////////////
+// Project: Pong
+// File:    PongPack.cpp
+//////////////////////////////////////////////////////////////////////////////////
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "../../include/Constants.h"
+#include "../../include/AssetBundle.h"
+
+// whole file into memory
+bool readFile(std::string path, std::vector<unsigned char>* data);
+
+// uncompressed 24 or 32 bit bmp to ARGB8888, color key pixels become transparent
+bool decodeBmp(const std::vector<unsigned char>& file, unsigned int colorKey,
+	std::vector<unsigned char>* pixels, int* width, int* height);
+
+// PongPack <resources directory> <bundle>
+int main(int argc, char** argv) {
+	if (argc != 3) {
+		printf("usage: PongPack <resources directory> <bundle>\n");
+		return 1;
+	}
+	std::string resources = argv[1];
+	BundleWriter writer;
+
+	// sprite sheet, keyed and converted once here instead of at every start
+	std::vector<unsigned char> file;
+	std::vector<unsigned char> pixels;
+	int width = 0;
+	int height = 0;
+	if (!readFile(resources + "/images/Pong.bmp", &file) ||
+		!decodeBmp(file, SPRITE_COLOR_KEY, &pixels, &width, &height)) {
+		return 1;
+	}
+	writer.add(BUNDLE_SPRITE, &pixels[0], (unsigned int)pixels.size(), width, height);
+
+	// sprite clips
+	if (!readFile(resources + "/images/Pong.atlas", &file)) {
+		return 1;
+	}
+	writer.add(BUNDLE_SPRITE_ATLAS, &file[0], (unsigned int)file.size());
+
+	// font as it is, SDL_ttf reads it from memory
+	if (!readFile(resources + "/fonts/ARIAL.TTF", &file)) {
+		return 1;
+	}
+	writer.add(BUNDLE_FONT, &file[0], (unsigned int)file.size());
+
+	return writer.save(argv[2]) ? 0 : 1;
+}
+
+bool readFile(std::string path, std::vector<unsigned char>* data) {
+	data->clear();
+	FILE* file = fopen(path.c_str(), "rb");
+	if (file == NULL) {
+		printf("Unable to open %s!\n", path.c_str());
+		return false;
+	}
+	unsigned char buffer[4096];
+	size_t count;
+	while ((count = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+		data->insert(data->end(), buffer, buffer + count);
+	}
+	fclose(file);
+	if (data->empty()) {
+		printf("%s is empty!\n", path.c_str());
+		return false;
+	}
+	return true;
+}
+
+static unsigned int readU16(const unsigned char* in) {
+	return in[0] | (in[1] << 8);
+}
+
+static unsigned int readU32(const unsigned char* in) {
+	return readU16(in) | (readU16(in + 2) << 16);
+}
+
+bool decodeBmp(const std::vector<unsigned char>& file, unsigned int colorKey,
+	std::vector<unsigned char>* pixels, int* width, int* height) {
+	// file header 14 bytes, info header at least 40
+	if (file.size() < 54 || file[0] != 'B' || file[1] != 'M') {
+		printf("Sprite sheet is not a bmp!\n");
+		return false;
+	}
+	const unsigned char* data = &file[0];
+	unsigned int pixelOffset = readU32(data + 10);
+	int w = (int)readU32(data + 18);
+	int h = (int)readU32(data + 22);
+	unsigned int bits = readU16(data + 28);
+	unsigned int compression = readU32(data + 30);
+	if ((bits != 24 && bits != 32) || compression != 0 || w <= 0 || h == 0) {
+		printf("Sprite sheet must be an uncompressed 24 or 32 bit bmp!\n");
+		return false;
+	}
+	// rows are stored bottom up unless the height is negative
+	bool bottomUp = h > 0;
+	if (h < 0) {
+		h = -h;
+	}
+	unsigned int bytes = bits / 8;
+	size_t stride = ((size_t)w * bytes + 3) / 4 * 4;
+	if (pixelOffset + stride * h > file.size()) {
+		printf("Sprite sheet is truncated!\n");
+		return false;
+	}
+
+	pixels->resize((size_t)w * h * 4);
+	for (int y = 0; y < h; y++) {
+		const unsigned char* row = data + pixelOffset + stride * (bottomUp ? h - 1 - y : y);
+		unsigned char* out = &(*pixels)[(size_t)y * w * 4];
+		for (int x = 0; x < w; x++) {
+			const unsigned char* in = row + x * bytes;
+			unsigned int rgb = (in[2] << 16) | (in[1] << 8) | in[0];
+			// same as SDL_SetColorKey, key color is fully transparent
+			unsigned int alpha = rgb == colorKey ? 0 : 0xFF;
+			// ARGB8888 little endian is B G R A in memory
+			out[x * 4] = in[0];
+			out[x * 4 + 1] = in[1];
+			out[x * 4 + 2] = in[2];
+			out[x * 4 + 3] = (unsigned char)alpha;
+		}
+	}
+	*width = w;
+	*height = h;
+	return true;
+}
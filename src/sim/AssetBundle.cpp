@@ -0,0 +1,234 @@
+//////////////////////////////////////////////////////////////////////////////////
+// Project: Pong
+// File:    AssetBundle.cpp
+//////////////////////////////////////////////////////////////////////////////////
+
+#include <cstdio>
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "../../include/AssetBundle.h"
+
+// little endian helpers
+static void writeU32(std::vector<unsigned char>& out, unsigned int value) {
+	for (int i = 0; i < 4; i++) {
+		out.push_back((unsigned char)((value >> (i * 8)) & 0xFF));
+	}
+}
+
+static unsigned int readU32(const unsigned char* in) {
+	return in[0] | (in[1] << 8) | (in[2] << 16) | ((unsigned int)in[3] << 24);
+}
+
+MappedFile::MappedFile() {
+	mData = NULL;
+	mSize = 0;
+#ifdef _WIN32
+	mFile = INVALID_HANDLE_VALUE;
+	mMapping = NULL;
+#endif
+}
+
+MappedFile::~MappedFile() {
+	close();
+}
+
+bool MappedFile::open(std::string path) {
+	close();
+#ifdef _WIN32
+	mFile = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (mFile == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(mFile, &size) || size.QuadPart == 0) {
+		close();
+		return false;
+	}
+	mMapping = CreateFileMappingA(mFile, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (mMapping == NULL) {
+		close();
+		return false;
+	}
+	mData = (const unsigned char*)MapViewOfFile(mMapping, FILE_MAP_READ, 0, 0, 0);
+	mSize = (size_t)size.QuadPart;
+#else
+	int file = ::open(path.c_str(), O_RDONLY);
+	if (file < 0) {
+		return false;
+	}
+	struct stat info;
+	if (fstat(file, &info) != 0 || info.st_size == 0) {
+		::close(file);
+		return false;
+	}
+	void* data = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+	// the mapping keeps the file alive
+	::close(file);
+	if (data == MAP_FAILED) {
+		return false;
+	}
+	mData = (const unsigned char*)data;
+	mSize = (size_t)info.st_size;
+#endif
+	if (mData == NULL) {
+		close();
+		return false;
+	}
+	return true;
+}
+
+void MappedFile::close() {
+#ifdef _WIN32
+	if (mData != NULL) {
+		UnmapViewOfFile(mData);
+	}
+	if (mMapping != NULL) {
+		CloseHandle(mMapping);
+		mMapping = NULL;
+	}
+	if (mFile != INVALID_HANDLE_VALUE) {
+		CloseHandle(mFile);
+		mFile = INVALID_HANDLE_VALUE;
+	}
+#else
+	if (mData != NULL) {
+		munmap((void*)mData, mSize);
+	}
+#endif
+	mData = NULL;
+	mSize = 0;
+}
+
+const unsigned char* MappedFile::getData() {
+	return mData;
+}
+
+size_t MappedFile::getSize() {
+	return mSize;
+}
+
+bool AssetBundle::open(std::string path) {
+	close();
+	if (!mFile.open(path)) {
+		printf("Unable to map asset bundle %s!\n", path.c_str());
+		return false;
+	}
+	const unsigned char* data = mFile.getData();
+	size_t size = mFile.getSize();
+	if (size < (size_t)BUNDLE_HEADER_SIZE || memcmp(data, BUNDLE_MAGIC, 4) != 0 || readU32(data + 4) != BUNDLE_VERSION) {
+		printf("Asset bundle %s is not a version %d bundle!\n", path.c_str(), BUNDLE_VERSION);
+		close();
+		return false;
+	}
+
+	// entry table, every entry has to lie inside the file
+	unsigned int count = readU32(data + 8);
+	if (size < BUNDLE_HEADER_SIZE + (size_t)count * BUNDLE_ENTRY_SIZE) {
+		printf("Asset bundle %s is truncated!\n", path.c_str());
+		close();
+		return false;
+	}
+	for (unsigned int i = 0; i < count; i++) {
+		const unsigned char* in = data + BUNDLE_HEADER_SIZE + i * BUNDLE_ENTRY_SIZE;
+		BundleEntry entry;
+		memcpy(entry.name, in, BUNDLE_NAME_LENGTH);
+		entry.name[BUNDLE_NAME_LENGTH - 1] = '\0';
+		entry.offset = readU32(in + BUNDLE_NAME_LENGTH);
+		entry.size = readU32(in + BUNDLE_NAME_LENGTH + 4);
+		entry.width = readU32(in + BUNDLE_NAME_LENGTH + 8);
+		entry.height = readU32(in + BUNDLE_NAME_LENGTH + 12);
+		if ((size_t)entry.offset + entry.size > size) {
+			printf("Asset bundle %s is truncated!\n", path.c_str());
+			close();
+			return false;
+		}
+		// an image has to hold exactly its ARGB8888 pixels, it goes to the texture unchecked
+		if ((entry.width != 0 || entry.height != 0) &&
+			(entry.width > BUNDLE_MAX_IMAGE_SIDE || entry.height > BUNDLE_MAX_IMAGE_SIDE ||
+			entry.size != (unsigned long long)entry.width * entry.height * 4)) {
+			printf("Asset bundle %s has a broken image %s!\n", path.c_str(), entry.name);
+			close();
+			return false;
+		}
+		mEntries.push_back(entry);
+	}
+	return true;
+}
+
+void AssetBundle::close() {
+	mFile.close();
+	mEntries.clear();
+}
+
+const BundleEntry* AssetBundle::find(const char* name) {
+	for (size_t i = 0; i < mEntries.size(); i++) {
+		if (strcmp(mEntries[i].name, name) == 0) {
+			return &mEntries[i];
+		}
+	}
+	printf("Asset bundle has no entry %s!\n", name);
+	return NULL;
+}
+
+const unsigned char* AssetBundle::getData(const BundleEntry* entry) {
+	return mFile.getData() + entry->offset;
+}
+
+void BundleWriter::add(const char* name, const void* data, unsigned int size, unsigned int width, unsigned int height) {
+	BundleEntry entry;
+	memset(&entry, 0, sizeof(entry));
+	strncpy(entry.name, name, BUNDLE_NAME_LENGTH - 1);
+	// offset within the data block for now, save adds the table size
+	while (mData.size() % BUNDLE_ALIGN != 0) {
+		mData.push_back(0);
+	}
+	entry.offset = (unsigned int)mData.size();
+	entry.size = size;
+	entry.width = width;
+	entry.height = height;
+	mData.insert(mData.end(), (const unsigned char*)data, (const unsigned char*)data + size);
+	mEntries.push_back(entry);
+}
+
+bool BundleWriter::save(std::string path) {
+	std::vector<unsigned char> header;
+	header.insert(header.end(), BUNDLE_MAGIC, BUNDLE_MAGIC + 4);
+	writeU32(header, BUNDLE_VERSION);
+	writeU32(header, (unsigned int)mEntries.size());
+	writeU32(header, 0);
+	// data starts aligned after the table
+	unsigned int base = BUNDLE_HEADER_SIZE + (unsigned int)mEntries.size() * BUNDLE_ENTRY_SIZE;
+	base = (base + BUNDLE_ALIGN - 1) / BUNDLE_ALIGN * BUNDLE_ALIGN;
+	for (size_t i = 0; i < mEntries.size(); i++) {
+		header.insert(header.end(), mEntries[i].name, mEntries[i].name + BUNDLE_NAME_LENGTH);
+		writeU32(header, base + mEntries[i].offset);
+		writeU32(header, mEntries[i].size);
+		writeU32(header, mEntries[i].width);
+		writeU32(header, mEntries[i].height);
+	}
+	header.resize(base, 0);
+
+	FILE* file = fopen(path.c_str(), "wb");
+	if (file == NULL) {
+		printf("Unable to write asset bundle %s!\n", path.c_str());
+		return false;
+	}
+	bool success = fwrite(&header[0], 1, header.size(), file) == header.size();
+	if (success && !mData.empty()) {
+		success = fwrite(&mData[0], 1, mData.size(), file) == mData.size();
+	}
+	fclose(file);
+	if (!success) {
+		printf("Unable to write asset bundle %s!\n", path.c_str());
+	}
+	return success;
+}
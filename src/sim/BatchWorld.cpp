@@ -0,0 +1,251 @@
+//////////////////////////////////////////////////////////////////////////////////
+// Project: Pong
+// File:    BatchWorld.cpp
+//////////////////////////////////////////////////////////////////////////////////
+
+#include "../../include/BatchWorld.h"
+#include "../../include/Sweep.h"
+
+// number of int arrays in the block
+const int BATCH_ARRAYS = 14;
+
+// kernels stay out of line so the compiler keeps their __restrict promise
+#ifdef _MSC_VER
+#define BATCH_KERNEL static __declspec(noinline) void
+#else
+#define BATCH_KERNEL static __attribute__((noinline)) void
+#endif
+
+// kernels, every loop body is branch free so it compiles to simd selects
+
+// launch waiting balls with a random horizontal speed, same lcg as nextServeVelocity
+BATCH_KERNEL serveKernel(int n, int* __restrict start, int* __restrict velX, int* __restrict velY,
+	const int* __restrict speed, unsigned int* __restrict seed) {
+	for (int i = 0; i < n; i++) {
+		int waiting = start[i];
+		unsigned int next = seed[i] * 1103515245u + 12345u;
+		int serveX = ((int)((next >> 16) % (2 * SERVE_MAX_SPEED_X + 1)) - SERVE_MAX_SPEED_X) * SPEED_SCALE;
+		seed[i] = waiting ? next : seed[i];
+		velX[i] = waiting ? serveX : velX[i];
+		velY[i] = waiting ? speed[i] : velY[i];
+		start[i] = 0;
+	}
+}
+
+// computer control, follows the ball while it moves towards the sticky
+// sign is 1 for the bottom sticky and -1 for the top one, limitY is the sticky face
+BATCH_KERNEL trackKernel(int n, int sign, int limitY, const int* __restrict ballX, const int* __restrict ballY,
+	const int* __restrict ballVelY, const int* __restrict stickyX, int* __restrict stickyVelX) {
+	for (int i = 0; i < n; i++) {
+		int active = (ballVelY[i] * sign > 0) & ((ballY[i] - limitY) * sign < 0);
+		int velX = ballX[i] <= stickyX[i] ? -STICKY_VELOCITY : (ballX[i] >= stickyX[i] + toSubpixels(STICKY_WIDTH) ? STICKY_VELOCITY : 0);
+		stickyVelX[i] = active ? velX : 0;
+	}
+}
+
+// caller control, one direction per match
+BATCH_KERNEL actionKernel(int n, const int* __restrict actions, int* __restrict stickyVelX) {
+	for (int i = 0; i < n; i++) {
+		int action = actions[i] < 0 ? -1 : (actions[i] > 0 ? 1 : 0);
+		stickyVelX[i] = action * STICKY_VELOCITY;
+	}
+}
+
+// sticky move, stays put when the next position leaves the game area
+BATCH_KERNEL stickyMoveKernel(int n, int* __restrict stickyX, const int* __restrict stickyVelX) {
+	for (int i = 0; i < n; i++) {
+		int next = stickyX[i] + stickyVelX[i];
+		int blocked = (next < toSubpixels(GAME_AREA_LEFT)) | (next + toSubpixels(STICKY_WIDTH) > toSubpixels(GAME_AREA_RIGHT));
+		stickyX[i] = blocked ? stickyX[i] : next;
+	}
+}
+
+// score, then sweep and bounce, same rules as Simulation::changeBallSpeed
+BATCH_KERNEL ballKernel(int n, int* __restrict ballX, int* __restrict ballY, int* __restrict ballVelX, int* __restrict ballVelY,
+	int* __restrict ballSpeed, int* __restrict start, const int* __restrict computerX, const int* __restrict computerVelX,
+	const int* __restrict playerX, const int* __restrict playerVelX, int* __restrict playerScore, int* __restrict computerScore,
+	int* __restrict result) {
+	const int radius = toSubpixels(BALL_RADIUS);
+	for (int i = 0; i < n; i++) {
+		int x = ballX[i];
+		int y = ballY[i];
+
+		// score
+		int playerPoint = maskOf(y + radius < 0);
+		int computerPoint = maskOf(y - radius > toSubpixels(WINDOW_HEIGHT));
+		int ps = playerScore[i] - playerPoint;
+		int cs = computerScore[i] - computerPoint;
+		int res = selectMask(playerPoint, selectMask(maskOf(ps >= SCORE), TICK_PLAYER_WIN, TICK_PLAYER_SCORE), TICK_NONE);
+		res = selectMask(computerPoint, selectMask(maskOf(cs >= SCORE), TICK_COMPUTER_WIN, TICK_COMPUTER_SCORE), res);
+		int scored = playerPoint | computerPoint;
+		float fx = (float)selectMask(scored, toSubpixels(BALL_START_X), x);
+		float fy = (float)selectMask(scored, toSubpixels(BALL_START_Y), y);
+		int vx = selectMask(scored, 0, ballVelX[i]);
+		int vy = selectMask(scored, 0, ballVelY[i]);
+
+		// sweep through the tick
+		sweepBall(&fx, &fy, &vx, &vy,
+			(float)playerX[i], (float)toSubpixels(PLAYER_START_Y), playerVelX[i],
+			(float)computerX[i], (float)toSubpixels(COMPUTER_START_Y), computerVelX[i]);
+
+		ballX[i] = roundSubpixel(fx);
+		ballY[i] = roundSubpixel(fy);
+		ballVelX[i] = vx;
+		ballVelY[i] = vy;
+		ballSpeed[i] = selectMask(scored, BALL_INIT_VELOCITY, ballSpeed[i]);
+		start[i] = selectMask(scored, 1, start[i]);
+		playerScore[i] = ps;
+		computerScore[i] = cs;
+		result[i] = res;
+	}
+}
+
+BatchWorld::BatchWorld(int count, unsigned int seed) :
+	mCount(count), mSeed(seed) {
+	// round every array up to a whole number of cache lines
+	const int perLine = BATCH_ALIGN / sizeof(int);
+	int stride = (count + perLine - 1) / perLine * perLine;
+	mBlock = new char[BATCH_ARRAYS * stride * sizeof(int) + BATCH_ALIGN];
+	size_t offset = (size_t)mBlock % BATCH_ALIGN;
+	int* base = (int*)(mBlock + (offset == 0 ? 0 : BATCH_ALIGN - offset));
+
+	int** arrays[BATCH_ARRAYS - 1] = {
+		&mBallX, &mBallY, &mBallVelX, &mBallVelY, &mBallSpeed, &mStart,
+		&mComputerX, &mComputerVelX, &mPlayerX, &mPlayerVelX,
+		&mPlayerScore, &mComputerScore, &mResult
+	};
+	for (int i = 0; i < BATCH_ARRAYS - 1; i++) {
+		*arrays[i] = base + i * stride;
+	}
+	mServeSeed = (unsigned int*)(base + (BATCH_ARRAYS - 1) * stride);
+
+	reset();
+}
+
+BatchWorld::~BatchWorld()
+{
+	delete[] mBlock;
+}
+
+void BatchWorld::reset() {
+	for (int i = 0; i < mCount; i++) {
+		resetMatch(i);
+		mServeSeed[i] = mSeed + i;
+		mResult[i] = TICK_NONE;
+	}
+}
+
+void BatchWorld::resetMatch(int i) {
+	mBallX[i] = toSubpixels(BALL_START_X);
+	mBallY[i] = toSubpixels(BALL_START_Y);
+	mBallVelX[i] = 0;
+	mBallVelY[i] = 0;
+	mBallSpeed[i] = BALL_INIT_VELOCITY;
+	mStart[i] = 1;
+	mComputerX[i] = toSubpixels(COMPUTER_START_X);
+	mComputerVelX[i] = 0;
+	mPlayerX[i] = toSubpixels(PLAYER_START_X);
+	mPlayerVelX[i] = 0;
+	mPlayerScore[i] = 0;
+	mComputerScore[i] = 0;
+}
+
+void BatchWorld::step(const int* actions) {
+	int n = mCount;
+	serveKernel(n, mStart, mBallVelX, mBallVelY, mBallSpeed, mServeSeed);
+
+	// player sticky
+	if (actions == NULL) {
+		trackKernel(n, 1, toSubpixels(PLAYER_START_Y), mBallX, mBallY, mBallVelY, mPlayerX, mPlayerVelX);
+	} else {
+		actionKernel(n, actions, mPlayerVelX);
+	}
+	stickyMoveKernel(n, mPlayerX, mPlayerVelX);
+
+	// computer sticky
+	trackKernel(n, -1, toSubpixels(COMPUTER_START_Y + STICKY_HEIGHT), mBallX, mBallY, mBallVelY, mComputerX, mComputerVelX);
+	stickyMoveKernel(n, mComputerX, mComputerVelX);
+
+	// ball
+	ballKernel(n, mBallX, mBallY, mBallVelX, mBallVelY, mBallSpeed, mStart,
+		mComputerX, mComputerVelX, mPlayerX, mPlayerVelX, mPlayerScore, mComputerScore, mResult);
+
+	// finished matches start over, rare so a plain branch is fine
+	for (int i = 0; i < n; i++) {
+		if (mResult[i] == TICK_PLAYER_WIN || mResult[i] == TICK_COMPUTER_WIN) {
+			resetMatch(i);
+		}
+	}
+}
+
+int BatchWorld::getCount() const {
+	return mCount;
+}
+
+const int* BatchWorld::getBallX() const {
+	return mBallX;
+}
+
+const int* BatchWorld::getBallY() const {
+	return mBallY;
+}
+
+const int* BatchWorld::getBallVelocityX() const {
+	return mBallVelX;
+}
+
+const int* BatchWorld::getBallVelocityY() const {
+	return mBallVelY;
+}
+
+const int* BatchWorld::getComputerX() const {
+	return mComputerX;
+}
+
+const int* BatchWorld::getComputerVelocityX() const {
+	return mComputerVelX;
+}
+
+const int* BatchWorld::getPlayerX() const {
+	return mPlayerX;
+}
+
+const int* BatchWorld::getPlayerVelocityX() const {
+	return mPlayerVelX;
+}
+
+const int* BatchWorld::getPlayerScore() const {
+	return mPlayerScore;
+}
+
+const int* BatchWorld::getComputerScore() const {
+	return mComputerScore;
+}
+
+const int* BatchWorld::getResult() const {
+	return mResult;
+}
+
+void BatchWorld::getState(int i, SimState* state) const {
+	state->ball.centerX = mBallX[i];
+	state->ball.centerY = mBallY[i];
+	state->ball.velocityX = mBallVelX[i];
+	state->ball.velocityY = mBallVelY[i];
+	state->ball.radius = toSubpixels(BALL_RADIUS);
+	state->computer.startX = mComputerX[i];
+	state->computer.startY = toSubpixels(COMPUTER_START_Y);
+	state->computer.velocityX = mComputerVelX[i];
+	state->computer.velocityY = 0;
+	state->computer.width = toSubpixels(STICKY_WIDTH);
+	state->computer.height = toSubpixels(STICKY_HEIGHT);
+	state->player.startX = mPlayerX[i];
+	state->player.startY = toSubpixels(PLAYER_START_Y);
+	state->player.velocityX = mPlayerVelX[i];
+	state->player.velocityY = 0;
+	state->player.width = toSubpixels(STICKY_WIDTH);
+	state->player.height = toSubpixels(STICKY_HEIGHT);
+	state->playerScore = mPlayerScore[i];
+	state->computerScore = mComputerScore[i];
+	state->ballSpeed = mBallSpeed[i];
+	state->start = mStart[i] != 0;
+}
@@ -0,0 +1,266 @@
+//////////////////////////////////////////////////////////////////////////////////
+// Project: Pong
+// File:    MultiBall.cpp
+//////////////////////////////////////////////////////////////////////////////////
+
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+
+#include "../../include/MultiBall.h"
+#include "../../include/Sweep.h"
+
+const int MULTIBALL_CELL_SUBPIXELS = toSubpixels(MULTIBALL_CELL);
+const int MULTIBALL_CELL_COUNT = MULTIBALL_COLUMNS * MULTIBALL_ROWS;
+// balls are served from this far around the middle, so they do not start on top of each other, pixels
+const int MULTIBALL_SERVE_SPREAD_X = 60;
+const int MULTIBALL_SERVE_SPREAD_Y = 20;
+
+// random number in [0, range), same lcg as the serves
+static int nextRandom(unsigned int* seed, int range) {
+	*seed = *seed * 1103515245u + 12345u;
+	return (int)((*seed >> 8) % (unsigned int)range);
+}
+
+static int clampInt(int value, int low, int high) {
+	return value < low ? low : (value > high ? high : value);
+}
+
+// column or row of a subpixel position, positions off the board go to the border cells
+static int cellOf(int position, int cells) {
+	return clampInt(position / MULTIBALL_CELL_SUBPIXELS, 0, cells - 1);
+}
+
+MultiBallWorld::MultiBallWorld() {
+	mCount = 0;
+	mSeed = 0;
+	mContacts = 0;
+}
+
+void MultiBallWorld::reset(int count, unsigned int seed) {
+	// the pool is allocated once, ticks never allocate
+	if (mX.empty()) {
+		mX.resize(MULTIBALL_MAX_BALLS);
+		mY.resize(MULTIBALL_MAX_BALLS);
+		mVelX.resize(MULTIBALL_MAX_BALLS);
+		mVelY.resize(MULTIBALL_MAX_BALLS);
+		mBallCell.resize(MULTIBALL_MAX_BALLS);
+		mSortedX.resize(MULTIBALL_MAX_BALLS);
+		mSortedY.resize(MULTIBALL_MAX_BALLS);
+		mSortedVelX.resize(MULTIBALL_MAX_BALLS);
+		mSortedVelY.resize(MULTIBALL_MAX_BALLS);
+		mCellStart.resize(MULTIBALL_CELL_COUNT + 1);
+	}
+	mCount = 0;
+	mSeed = seed;
+	mContacts = 0;
+	count = std::min(count, MULTIBALL_MAX_BALLS);
+	for (int i = 0; i < count; i++) {
+		mCount++;
+		serve(i);
+	}
+}
+
+void MultiBallWorld::step(const StickyState& player, const StickyState& computer) {
+	mContacts = 0;
+	if (mCount == 0) {
+		return;
+	}
+	moveBalls();
+	buildGrid();
+	collideBalls();
+	collideSticky(player);
+	collideSticky(computer);
+}
+
+int MultiBallWorld::getCount() const {
+	return mCount;
+}
+
+const int* MultiBallWorld::getBallX() const {
+	return mX.empty() ? NULL : &mX[0];
+}
+
+const int* MultiBallWorld::getBallY() const {
+	return mY.empty() ? NULL : &mY[0];
+}
+
+int MultiBallWorld::getContacts() const {
+	return mContacts;
+}
+
+void MultiBallWorld::moveBalls() {
+	const int radius = toSubpixels(MULTIBALL_RADIUS);
+	const int left = toSubpixels(GAME_AREA_LEFT) + radius;
+	const int right = toSubpixels(GAME_AREA_RIGHT) - radius;
+	const int bottom = toSubpixels(WINDOW_HEIGHT) + radius;
+	for (int i = 0; i < mCount; i++) {
+		// contacts round their impulses, keep the speed limit
+		int velX = clampInt(mVelX[i], -MULTIBALL_MAX_VELOCITY, MULTIBALL_MAX_VELOCITY);
+		int velY = clampInt(mVelY[i], -MULTIBALL_MAX_VELOCITY, MULTIBALL_MAX_VELOCITY);
+		int x = mX[i] + velX;
+		int y = mY[i] + velY;
+		// side walls mirror the horizontal speed
+		if (x < left) {
+			x = left;
+			velX = std::abs(velX);
+		} else if (x > right) {
+			x = right;
+			velX = -std::abs(velX);
+		}
+		mX[i] = x;
+		mY[i] = y;
+		mVelX[i] = velX;
+		mVelY[i] = velY;
+		// past a sticky and off the board
+		if (y < -radius || y > bottom) {
+			serve(i);
+		}
+	}
+}
+
+void MultiBallWorld::buildGrid() {
+	// balls per cell, then where each cell starts
+	std::fill(mCellStart.begin(), mCellStart.end(), 0);
+	for (int i = 0; i < mCount; i++) {
+		int cell = cellOf(mY[i], MULTIBALL_ROWS) * MULTIBALL_COLUMNS + cellOf(mX[i], MULTIBALL_COLUMNS);
+		mBallCell[i] = cell;
+		mCellStart[cell + 1]++;
+	}
+	for (int cell = 0; cell < MULTIBALL_CELL_COUNT; cell++) {
+		mCellStart[cell + 1] += mCellStart[cell];
+	}
+	// balls of a cell next to each other, and the rows of the board after each other
+	for (int i = 0; i < mCount; i++) {
+		int to = mCellStart[mBallCell[i]]++;
+		mSortedX[to] = mX[i];
+		mSortedY[to] = mY[i];
+		mSortedVelX[to] = mVelX[i];
+		mSortedVelY[to] = mVelY[i];
+	}
+	// every start moved to the next cell, move them back
+	for (int cell = MULTIBALL_CELL_COUNT; cell > 0; cell--) {
+		mCellStart[cell] = mCellStart[cell - 1];
+	}
+	mCellStart[0] = 0;
+	mX.swap(mSortedX);
+	mY.swap(mSortedY);
+	mVelX.swap(mSortedVelX);
+	mVelY.swap(mSortedVelY);
+}
+
+void MultiBallWorld::collideBalls() {
+	for (int row = 0; row < MULTIBALL_ROWS; row++) {
+		for (int column = 0; column < MULTIBALL_COLUMNS; column++) {
+			int cell = row * MULTIBALL_COLUMNS + column;
+			int end = mCellStart[cell + 1];
+			for (int a = mCellStart[cell]; a < end; a++) {
+				// every pair once, the cell itself, the next cell in the row and three cells in the next row
+				for (int b = a + 1; b < end; b++) {
+					collidePair(a, b);
+				}
+				if (column + 1 < MULTIBALL_COLUMNS) {
+					for (int b = mCellStart[cell + 1]; b < mCellStart[cell + 2]; b++) {
+						collidePair(a, b);
+					}
+				}
+				if (row + 1 < MULTIBALL_ROWS) {
+					int below = cell + MULTIBALL_COLUMNS;
+					int first = below + (column > 0 ? -1 : 0);
+					int last = below + (column + 1 < MULTIBALL_COLUMNS ? 1 : 0);
+					// the cells of a row are next to each other in the pool
+					for (int b = mCellStart[first]; b < mCellStart[last + 1]; b++) {
+						collidePair(a, b);
+					}
+				}
+			}
+		}
+	}
+}
+
+void MultiBallWorld::collidePair(int a, int b) {
+	const float diameter = (float)toSubpixels(2 * MULTIBALL_RADIUS);
+	float dx = (float)(mX[b] - mX[a]);
+	float dy = (float)(mY[b] - mY[a]);
+	float distance2 = dx * dx + dy * dy;
+	if (distance2 >= diameter * diameter) {
+		return;
+	}
+	mContacts++;
+	float distance = std::sqrt(distance2);
+	// balls right on top of each other part sideways
+	float nx = distance > 0.0f ? dx / distance : 1.0f;
+	float ny = distance > 0.0f ? dy / distance : 0.0f;
+	// equal masses, the speeds along the normal are swapped while the balls approach
+	float approach = (mVelX[a] - mVelX[b]) * nx + (mVelY[a] - mVelY[b]) * ny;
+	if (approach > 0.0f) {
+		int impulseX = roundSubpixel(approach * nx);
+		int impulseY = roundSubpixel(approach * ny);
+		mVelX[a] -= impulseX;
+		mVelY[a] -= impulseY;
+		mVelX[b] += impulseX;
+		mVelY[b] += impulseY;
+	}
+	// push apart, half the overlap each
+	float push = (diameter - distance) * 0.5f;
+	int pushX = roundSubpixel(nx * push);
+	int pushY = roundSubpixel(ny * push);
+	mX[a] -= pushX;
+	mY[a] -= pushY;
+	mX[b] += pushX;
+	mY[b] += pushY;
+}
+
+void MultiBallWorld::collideSticky(const StickyState& sticky) {
+	const int radius = toSubpixels(MULTIBALL_RADIUS);
+	int left = sticky.startX;
+	int right = sticky.startX + sticky.width;
+	int top = sticky.startY;
+	int bottom = sticky.startY + sticky.height;
+	// one cell more on every side, ball contacts moved some balls since the grid was built
+	int firstColumn = cellOf(left - radius, MULTIBALL_COLUMNS) - 1;
+	int lastColumn = cellOf(right + radius, MULTIBALL_COLUMNS) + 1;
+	int firstRow = cellOf(top - radius, MULTIBALL_ROWS) - 1;
+	int lastRow = cellOf(bottom + radius, MULTIBALL_ROWS) + 1;
+	firstColumn = std::max(firstColumn, 0);
+	lastColumn = std::min(lastColumn, MULTIBALL_COLUMNS - 1);
+	firstRow = std::max(firstRow, 0);
+	lastRow = std::min(lastRow, MULTIBALL_ROWS - 1);
+	for (int row = firstRow; row <= lastRow; row++) {
+		// the cells of a row are next to each other in the pool
+		int first = mCellStart[row * MULTIBALL_COLUMNS + firstColumn];
+		int last = mCellStart[row * MULTIBALL_COLUMNS + lastColumn + 1];
+		for (int i = first; i < last; i++) {
+			int x = mX[i];
+			int y = mY[i];
+			// closest point of the sticky, like checkEntityCollision
+			long long dx = x - clampInt(x, left, right);
+			long long dy = y - clampInt(y, top, bottom);
+			if (dx * dx + dy * dy >= (long long)radius * radius) {
+				continue;
+			}
+			if (x >= left && x <= right) {
+				// face, faster and pushed along by the sticky like the match ball
+				bool above = y < (top + bottom) / 2;
+				int speed = std::min(std::abs(mVelY[i]) + BALL_CHANGE_VELOCITY, MULTIBALL_MAX_VELOCITY);
+				mVelY[i] = above ? -speed : speed;
+				mVelX[i] = clampInt(mVelX[i] + sticky.velocityX, -MULTIBALL_MAX_VELOCITY, MULTIBALL_MAX_VELOCITY);
+				mY[i] = above ? top - radius : bottom + radius;
+			} else {
+				// side, mirrored
+				bool before = x < left;
+				mVelX[i] = before ? -std::abs(mVelX[i]) : std::abs(mVelX[i]);
+				mX[i] = before ? left - radius : right + radius;
+			}
+		}
+	}
+}
+
+void MultiBallWorld::serve(int i) {
+	mX[i] = toSubpixels(BALL_START_X - MULTIBALL_SERVE_SPREAD_X) + nextRandom(&mSeed, toSubpixels(2 * MULTIBALL_SERVE_SPREAD_X));
+	mY[i] = toSubpixels(BALL_START_Y - MULTIBALL_SERVE_SPREAD_Y) + nextRandom(&mSeed, toSubpixels(2 * MULTIBALL_SERVE_SPREAD_Y));
+	mVelX[i] = nextRandom(&mSeed, MULTIBALL_MAX_VELOCITY + 1) - MULTIBALL_MAX_VELOCITY / 2;
+	// never flat, every ball reaches a sticky
+	int speed = MULTIBALL_MAX_VELOCITY / 4 + nextRandom(&mSeed, MULTIBALL_MAX_VELOCITY / 4);
+	mVelY[i] = nextRandom(&mSeed, 2) ? speed : -speed;
+}
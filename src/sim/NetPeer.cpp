@@ -0,0 +1,230 @@
+//////////////////////////////////////////////////////////////////////////////////
+// Project: Pong
+// File:    NetPeer.cpp
+//////////////////////////////////////////////////////////////////////////////////
+
+#include <cstdio>
+#include <cstring>
+
+#include "../../include/NetPeer.h"
+#include "../../include/Replay.h"
+
+// little endian helpers
+static void writeU16(unsigned char* out, unsigned int value) {
+	out[0] = (unsigned char)(value & 0xFF);
+	out[1] = (unsigned char)((value >> 8) & 0xFF);
+}
+
+static void writeU32(unsigned char* out, unsigned int value) {
+	writeU16(out, value & 0xFFFF);
+	writeU16(out + 2, value >> 16);
+}
+
+static unsigned int readU16(const unsigned char* in) {
+	return in[0] | (in[1] << 8);
+}
+
+static unsigned int readU32(const unsigned char* in) {
+	return readU16(in) | (readU16(in + 2) << 16);
+}
+
+// magic, type and session
+static void writeHeader(unsigned char* out, NetPacketType type, unsigned int session) {
+	memcpy(out, NET_MAGIC, 4);
+	out[4] = (unsigned char)type;
+	writeU32(out + 5, session);
+}
+
+NetPeer::NetPeer() {
+	mPeer.host = 0;
+	mPeer.port = 0;
+	mHost = false;
+	mConnected = false;
+	mSession = 0;
+	mLastHello = 0;
+	mLastHelloSent = false;
+	mLastReceived = 0;
+	mDelay = 0;
+	mDelayedFirst = 0;
+	mDelayedCount = 0;
+}
+
+bool NetPeer::host(int port) {
+	close();
+	if (!mSocket.open(port)) {
+		printf("Unable to listen on port %d!\n", port);
+		return false;
+	}
+	mHost = true;
+	return true;
+}
+
+bool NetPeer::join(const char* name, int port, unsigned int session) {
+	close();
+	if (!resolveAddress(name, port, &mPeer)) {
+		printf("Unable to resolve %s!\n", name);
+		return false;
+	}
+	if (!mSocket.open(0)) {
+		printf("Unable to open socket!\n");
+		return false;
+	}
+	mHost = false;
+	mSession = session;
+	// ask right away
+	mLastHelloSent = false;
+	return true;
+}
+
+void NetPeer::close() {
+	mSocket.close();
+	mConnected = false;
+	mDelayedFirst = 0;
+	mDelayedCount = 0;
+}
+
+void NetPeer::setDelay(int ms) {
+	mDelay = ms > 0 ? ms : 0;
+}
+
+bool NetPeer::connect(unsigned int now) {
+	if (!mSocket.isOpen()) {
+		return false;
+	}
+	if (mConnected) {
+		return true;
+	}
+	if (!mHost && (!mLastHelloSent || now - mLastHello >= (unsigned int)NET_HELLO_INTERVAL_MS)) {
+		sendHello();
+		mLastHello = now;
+		mLastHelloSent = true;
+	}
+
+	unsigned char data[NET_MAX_PACKET];
+	NetAddress from;
+	int size;
+	while (!mConnected && (size = mSocket.receive(&from, data, sizeof(data))) > 0) {
+		if (size < NET_HEADER_SIZE || memcmp(data, NET_MAGIC, 4) != 0) {
+			continue;
+		}
+		unsigned int session = readU32(data + 5);
+		if (mHost && data[4] == NET_HELLO) {
+			// first player to ask gets the game
+			mPeer = from;
+			mSession = session;
+			mConnected = true;
+			sendHello();
+		} else if (!mHost && from == mPeer && session == mSession) {
+			// hello back, or the host already plays
+			mConnected = true;
+		}
+	}
+	if (mConnected) {
+		mLastReceived = now;
+	}
+	return mConnected;
+}
+
+bool NetPeer::receive(unsigned int now, RollbackSession* session) {
+	unsigned char data[NET_MAX_PACKET];
+	NetAddress from;
+	int size;
+	while ((size = mSocket.receive(&from, data, sizeof(data))) > 0) {
+		if (!(from == mPeer)) {
+			continue;
+		}
+		if (mDelay == 0) {
+			if (readPacket(data, size, session)) {
+				mLastReceived = now;
+			}
+			continue;
+		}
+		// a full ring drops the packet like a congested link would
+		if (mDelayedCount < NET_DELAY_SLOTS) {
+			DelayedPacket& packet = mDelayed[(mDelayedFirst + mDelayedCount) % NET_DELAY_SLOTS];
+			packet.due = now + mDelay;
+			packet.size = size;
+			memcpy(packet.data, data, size);
+			mDelayedCount++;
+		}
+	}
+	// delayed packets that are due
+	while (mDelayedCount > 0 && (int)(now - mDelayed[mDelayedFirst].due) >= 0) {
+		DelayedPacket& packet = mDelayed[mDelayedFirst];
+		if (readPacket(packet.data, packet.size, session)) {
+			mLastReceived = now;
+		}
+		mDelayedFirst = (mDelayedFirst + 1) % NET_DELAY_SLOTS;
+		mDelayedCount--;
+	}
+	return now - mLastReceived < (unsigned int)NET_TIMEOUT_MS;
+}
+
+void NetPeer::send(RollbackSession* session) {
+	unsigned int tick = session->getTick();
+	unsigned int first = session->getLocalAck();
+	if (tick - first > (unsigned int)NET_MAX_INPUTS) {
+		first = tick - NET_MAX_INPUTS;
+	}
+	int count = (int)(tick - first);
+
+	unsigned char data[NET_MAX_PACKET];
+	writeHeader(data, NET_INPUT, mSession);
+	writeU32(data + NET_HEADER_SIZE, session->getConfirmedTick());
+	writeU32(data + NET_HEADER_SIZE + 4, tick);
+	writeU16(data + NET_HEADER_SIZE + 8, (unsigned int)(session->getAdvantage() & 0xFFFF));
+	writeU32(data + NET_HEADER_SIZE + 10, first);
+	data[NET_HEADER_SIZE + 14] = (unsigned char)count;
+	for (int i = 0; i < count; i++) {
+		data[NET_INPUT_HEADER_SIZE + i] = encodeInput(session->getLocalInput(first + i));
+	}
+	mSocket.send(mPeer, data, NET_INPUT_HEADER_SIZE + count);
+}
+
+bool NetPeer::isOpen() {
+	return mSocket.isOpen();
+}
+
+bool NetPeer::isConnected() {
+	return mConnected;
+}
+
+StickySide NetPeer::getLocalSide() {
+	return mHost ? SIDE_PLAYER : SIDE_COMPUTER;
+}
+
+void NetPeer::sendHello() {
+	unsigned char data[NET_HEADER_SIZE];
+	writeHeader(data, NET_HELLO, mSession);
+	mSocket.send(mPeer, data, NET_HEADER_SIZE);
+}
+
+bool NetPeer::readPacket(const unsigned char* data, int size, RollbackSession* session) {
+	if (size < NET_HEADER_SIZE || memcmp(data, NET_MAGIC, 4) != 0 || readU32(data + 5) != mSession) {
+		return false;
+	}
+	if (data[4] == NET_HELLO) {
+		// our hello back got lost, the joining player still asks
+		if (mHost) {
+			sendHello();
+		}
+		return true;
+	}
+	if (data[4] != NET_INPUT || size < NET_INPUT_HEADER_SIZE) {
+		return false;
+	}
+	unsigned int ack = readU32(data + NET_HEADER_SIZE);
+	unsigned int tick = readU32(data + NET_HEADER_SIZE + 4);
+	int advantage = (short)readU16(data + NET_HEADER_SIZE + 8);
+	unsigned int first = readU32(data + NET_HEADER_SIZE + 10);
+	int count = data[NET_HEADER_SIZE + 14];
+	if (size < NET_INPUT_HEADER_SIZE + count) {
+		return false;
+	}
+	session->setLocalAck(ack);
+	session->setRemoteTick(tick, advantage);
+	for (int i = 0; i < count; i++) {
+		session->addRemoteInput(first + i, decodeInput(data[NET_INPUT_HEADER_SIZE + i]));
+	}
+	return true;
+}
@@ -0,0 +1,150 @@
+//////////////////////////////////////////////////////////////////////////////////
+// Project: Pong
+// File:    NetSocket.cpp
+//////////////////////////////////////////////////////////////////////////////////
+
+#include <cstring>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#ifdef _MSC_VER
+#pragma comment(lib, "ws2_32.lib")
+#endif
+typedef int socklen_t;
+#else
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#include "../../include/NetSocket.h"
+
+#ifdef _WIN32
+const ptrdiff_t NO_SOCKET = (ptrdiff_t)INVALID_SOCKET;
+
+// winsock has to be started once per process
+static bool startNetwork() {
+	static bool started = false;
+	if (!started) {
+		WSADATA data;
+		started = WSAStartup(MAKEWORD(2, 2), &data) == 0;
+	}
+	return started;
+}
+#else
+const ptrdiff_t NO_SOCKET = -1;
+
+static bool startNetwork() {
+	return true;
+}
+#endif
+
+static sockaddr_in toSockaddr(const NetAddress& address) {
+	sockaddr_in result;
+	memset(&result, 0, sizeof(result));
+	result.sin_family = AF_INET;
+	result.sin_addr.s_addr = htonl(address.host);
+	result.sin_port = htons(address.port);
+	return result;
+}
+
+bool resolveAddress(const char* name, int port, NetAddress* address) {
+	if (!startNetwork()) {
+		return false;
+	}
+	addrinfo hints;
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_INET;
+	hints.ai_socktype = SOCK_DGRAM;
+	addrinfo* info = NULL;
+	if (getaddrinfo(name, NULL, &hints, &info) != 0 || info == NULL) {
+		return false;
+	}
+	address->host = ntohl(((sockaddr_in*)info->ai_addr)->sin_addr.s_addr);
+	address->port = (unsigned short)port;
+	freeaddrinfo(info);
+	return true;
+}
+
+bool operator==(const NetAddress& a, const NetAddress& b) {
+	return a.host == b.host && a.port == b.port;
+}
+
+UdpSocket::UdpSocket() {
+	mSocket = NO_SOCKET;
+}
+
+UdpSocket::~UdpSocket() {
+	close();
+}
+
+bool UdpSocket::open(int port) {
+	close();
+	if (!startNetwork()) {
+		return false;
+	}
+	mSocket = (ptrdiff_t)socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	if (mSocket == NO_SOCKET) {
+		return false;
+	}
+	NetAddress any = { INADDR_ANY, (unsigned short)port };
+	sockaddr_in local = toSockaddr(any);
+	if (bind(mSocket, (sockaddr*)&local, sizeof(local)) != 0) {
+		close();
+		return false;
+	}
+	// never block the frame
+#ifdef _WIN32
+	u_long nonBlocking = 1;
+	bool success = ioctlsocket(mSocket, FIONBIO, &nonBlocking) == 0;
+#else
+	bool success = fcntl((int)mSocket, F_SETFL, fcntl((int)mSocket, F_GETFL, 0) | O_NONBLOCK) == 0;
+#endif
+	if (!success) {
+		close();
+	}
+	return success;
+}
+
+void UdpSocket::close() {
+	if (mSocket != NO_SOCKET) {
+#ifdef _WIN32
+		closesocket(mSocket);
+#else
+		::close((int)mSocket);
+#endif
+		mSocket = NO_SOCKET;
+	}
+}
+
+bool UdpSocket::send(const NetAddress& to, const void* data, int size) {
+	sockaddr_in remote = toSockaddr(to);
+	return sendto(mSocket, (const char*)data, size, 0, (sockaddr*)&remote, sizeof(remote)) == size;
+}
+
+int UdpSocket::receive(NetAddress* from, void* data, int size) {
+	sockaddr_in remote;
+	socklen_t length = sizeof(remote);
+	int received = (int)recvfrom(mSocket, (char*)data, size, 0, (sockaddr*)&remote, &length);
+	if (received < 0) {
+#ifdef _WIN32
+		int error = WSAGetLastError();
+		// connection reset only means an earlier datagram was not delivered
+		return error == WSAEWOULDBLOCK || error == WSAECONNRESET ? 0 : -1;
+#else
+		return errno == EAGAIN || errno == EWOULDBLOCK || errno == ECONNREFUSED ? 0 : -1;
+#endif
+	}
+	from->host = ntohl(remote.sin_addr.s_addr);
+	from->port = ntohs(remote.sin_port);
+	return received;
+}
+
+bool UdpSocket::isOpen() {
+	return mSocket != NO_SOCKET;
+}
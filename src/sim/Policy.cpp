@@ -0,0 +1,200 @@
+//////////////////////////////////////////////////////////////////////////////////
+// Project: Pong
+// File:    Policy.cpp
+//////////////////////////////////////////////////////////////////////////////////
+
+#include <cstring>
+
+#include "../../include/Policy.h"
+
+// own sticky of a side
+static const StickyState& ownSticky(const SimState& state, StickySide side) {
+	return side == SIDE_PLAYER ? state.player : state.computer;
+}
+
+// ball flies towards the side and has not passed the sticky yet
+static bool ballComing(const SimState& state, StickySide side) {
+	const BallState& ball = state.ball;
+	const StickyState& own = ownSticky(state, side);
+	if (side == SIDE_PLAYER) {
+		return ball.velocityY > 0 && ball.centerY < own.startY;
+	}
+	return ball.velocityY < 0 && ball.centerY > own.startY + own.height;
+}
+
+// direction that moves the sticky under x, same rule as changeComputerStickySpeed
+static int steerTo(const StickyState& own, int x) {
+	if (x <= own.startX) {
+		return -1;
+	} else if (x >= own.startX + own.width) {
+		return 1;
+	}
+	return 0;
+}
+
+int trackerPolicy(const SimState& state, StickySide side) {
+	if (ballComing(state, side)) {
+		return steerTo(ownSticky(state, side), state.ball.centerX);
+	}
+	return 0;
+}
+
+int followerPolicy(const SimState& state, StickySide side) {
+	return steerTo(ownSticky(state, side), state.ball.centerX);
+}
+
+int keeperPolicy(const SimState& state, StickySide side) {
+	if (ballComing(state, side)) {
+		return steerTo(ownSticky(state, side), state.ball.centerX);
+	}
+	// back to the middle, stop within one step so it does not shake
+	const StickyState& own = ownSticky(state, side);
+	int center = own.startX + own.width / 2;
+	if (center < toSubpixels(WINDOW_WIDTH / 2) - STICKY_VELOCITY) {
+		return 1;
+	} else if (center > toSubpixels(WINDOW_WIDTH / 2) + STICKY_VELOCITY) {
+		return -1;
+	}
+	return 0;
+}
+
+int lazyPolicy(const SimState& state, StickySide side) {
+	int middle = toSubpixels(BALL_START_Y);
+	bool ownHalf = side == SIDE_PLAYER ? state.ball.centerY > middle : state.ball.centerY < middle;
+	if (ownHalf && ballComing(state, side)) {
+		return steerTo(ownSticky(state, side), state.ball.centerX);
+	}
+	return 0;
+}
+
+int predictBallX(const BallState& ball, int y) {
+	// ball center stays inside [low, low + span]
+	int low = toSubpixels(GAME_AREA_LEFT) + ball.radius;
+	int span = toSubpixels(GAME_AREA_RIGHT) - ball.radius - low;
+	if (ball.velocityY == 0 || span <= 0) {
+		return ball.centerX;
+	}
+	// straight line as if there were no walls, 64 bits for the product
+	long long x = ball.centerX - low + (long long)ball.velocityX * (y - ball.centerY) / ball.velocityY;
+	// every wall mirrors the rest of the line, so the path repeats every two spans
+	long long period = 2LL * span;
+	x %= period;
+	if (x < 0) {
+		x += period;
+	}
+	if (x > span) {
+		x = period - x;
+	}
+	return low + (int)x;
+}
+
+// same number for every tick of one flight of the ball, a wall bounce only flips velocityX
+static int aimError(const SimState& state, int error) {
+	if (error <= 0) {
+		return 0;
+	}
+	unsigned int hash = (unsigned int)(state.ball.velocityX < 0 ? -state.ball.velocityX : state.ball.velocityX);
+	hash = hash * 2654435761u ^ (unsigned int)state.ball.velocityY;
+	hash = hash * 2654435761u ^ (unsigned int)(state.playerScore * 8 + state.computerScore);
+	hash ^= hash >> 15;
+	hash *= 2246822519u;
+	hash ^= hash >> 13;
+	return (int)(hash % (unsigned int)(2 * error + 1)) - error;
+}
+
+// direction that moves the sticky center to x, stops within one step so it does not shake
+static int centerTo(const StickyState& own, int x) {
+	int center = own.startX + own.width / 2;
+	if (center < x - STICKY_VELOCITY) {
+		return 1;
+	} else if (center > x + STICKY_VELOCITY) {
+		return -1;
+	}
+	return 0;
+}
+
+int predictorDirection(const SimState& state, StickySide side, const PredictorSkill& skill) {
+	const BallState& ball = state.ball;
+	const StickyState& own = ownSticky(state, side);
+	const StickyState& other = side == SIDE_PLAYER ? state.computer : state.player;
+	// lines the ball center crosses when it meets a sticky face
+	int ownLine = side == SIDE_PLAYER ? own.startY - ball.radius : own.startY + own.height + ball.radius;
+	int otherLine = side == SIDE_PLAYER ? other.startY + other.height + ball.radius : other.startY - ball.radius;
+	int speed = ball.velocityY < 0 ? -ball.velocityY : ball.velocityY;
+	// ticks since the ball left the other sticky, a serve counts from its line as well
+	int flown = otherLine - ball.centerY;
+	flown = speed > 0 ? (flown < 0 ? -flown : flown) / speed : 0;
+	if (!ballComing(state, side) || flown < skill.reactionTicks) {
+		// wait in the middle
+		return centerTo(own, toSubpixels(WINDOW_WIDTH / 2));
+	}
+	int x = predictBallX(ball, ownLine) + aimError(state, skill.error);
+	if (skill.swingTicks <= 0) {
+		// stand on the landing point, the ball comes back mirrored
+		return centerTo(own, x);
+	}
+	// swing through the landing point away from the other sticky, the return takes the sticky velocity
+	int away = other.startX + other.width / 2 < x ? 1 : -1;
+	int arrive = ownLine - ball.centerY;
+	arrive = speed > 0 ? (arrive < 0 ? -arrive : arrive) / speed : 0;
+	if (arrive > skill.swingTicks) {
+		// wait one swing behind the landing point
+		return centerTo(own, x - away * skill.swingTicks * STICKY_VELOCITY);
+	}
+	// the target runs ahead of the sticky, it keeps moving while it is on time
+	return centerTo(own, x - away * (arrive - 2) * STICKY_VELOCITY);
+}
+
+int predictorEasyPolicy(const SimState& state, StickySide side) {
+	return predictorDirection(state, side, PREDICTOR_SKILLS[SKILL_EASY]);
+}
+
+int predictorNormalPolicy(const SimState& state, StickySide side) {
+	return predictorDirection(state, side, PREDICTOR_SKILLS[SKILL_NORMAL]);
+}
+
+int predictorHardPolicy(const SimState& state, StickySide side) {
+	return predictorDirection(state, side, PREDICTOR_SKILLS[SKILL_HARD]);
+}
+
+const PolicyEntry* findPolicy(const char* name) {
+	for (int i = 0; i < POLICY_COUNT; i++) {
+		if (strcmp(POLICIES[i].name, name) == 0) {
+			return &POLICIES[i];
+		}
+	}
+	return NULL;
+}
+
+MatchStats playPolicyMatch(Simulation& sim, PaddlePolicy player, PaddlePolicy computer,
+	unsigned int seed, long long maxTicks, long long maxRallyTicks) {
+	MatchStats stats;
+	stats.ticks = 0;
+	stats.stalledRallies = 0;
+	sim.reset();
+	long long rallyTicks = 0;
+	while (stats.ticks < maxTicks) {
+		// same serve as playMatch
+		if (sim.getState().start) {
+			sim.serve(nextServeVelocity(&seed));
+		}
+		const SimState& state = sim.getState();
+		sim.setPlayerVelocity(player(state, SIDE_PLAYER) * STICKY_VELOCITY);
+		sim.setComputerVelocity(computer(state, SIDE_COMPUTER) * STICKY_VELOCITY);
+		TickResult result = sim.advance();
+		stats.ticks++;
+		if (result == TICK_PLAYER_WIN || result == TICK_COMPUTER_WIN) {
+			break;
+		}
+		// a rally nobody can end is played again from the next serve
+		rallyTicks = result == TICK_NONE ? rallyTicks + 1 : 0;
+		if (maxRallyTicks > 0 && rallyTicks >= maxRallyTicks) {
+			sim.resetBall();
+			rallyTicks = 0;
+			stats.stalledRallies++;
+		}
+	}
+	stats.playerScore = sim.getState().playerScore;
+	stats.computerScore = sim.getState().computerScore;
+	return stats;
+}
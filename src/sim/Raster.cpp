@@ -0,0 +1,165 @@
+//////////////////////////////////////////////////////////////////////////////////
+// Project: Pong
+// File:    Raster.cpp
+//////////////////////////////////////////////////////////////////////////////////
+
+#include <cmath>
+#include <cstring>
+
+#include "../../include/Raster.h"
+#include "../../include/BatchWorld.h"
+
+// score pips, window pixels
+const int PIP_SIZE = 8;
+const int PIP_GAP = 4;
+const int PIP_TOP = (GAME_AREA_TOP - PIP_SIZE) / 2;
+
+// frame pixel of a subpixel position
+static int toPixel(int position, float scale) {
+	return (int)(position * scale + 0.5f);
+}
+
+static int clampPixel(int pixel, int size) {
+	return pixel < 0 ? 0 : (pixel > size ? size : pixel);
+}
+
+Rasterizer::Rasterizer(int width, int height, RasterFormat format) :
+	mWidth(width), mHeight(height), mFormat(format) {
+	mScaleX = (float)width / toSubpixels(WINDOW_WIDTH);
+	mScaleY = (float)height / toSubpixels(WINDOW_HEIGHT);
+	const unsigned int colors[PATTERN_COUNT] = {
+		RASTER_BOARD_COLOR, RASTER_COMPUTER_COLOR, RASTER_PLAYER_COLOR, RASTER_BALL_COLOR, RASTER_SCORE_COLOR
+	};
+	for (int i = 0; i < PATTERN_COUNT; i++) {
+		unsigned char r = (unsigned char)(colors[i] >> 16);
+		unsigned char g = (unsigned char)(colors[i] >> 8);
+		unsigned char b = (unsigned char)colors[i];
+		if (format == RASTER_GRAY) {
+			memset(mPatterns[i], (r * 77 + g * 150 + b * 29) >> 8, RASTER_CHUNK);
+		} else {
+			for (int j = 0; j < RASTER_CHUNK; j += 3) {
+				mPatterns[i][j] = r;
+				mPatterns[i][j + 1] = g;
+				mPatterns[i][j + 2] = b;
+			}
+		}
+	}
+}
+
+bool Rasterizer::isValid() {
+	return mWidth > 0 && mWidth <= RASTER_MAX_WIDTH && mHeight > 0 && mHeight <= RASTER_MAX_WIDTH &&
+		(mFormat == RASTER_GRAY || mFormat == RASTER_RGB);
+}
+
+int Rasterizer::getFrameSize() {
+	return mWidth * mHeight * mFormat;
+}
+
+void Rasterizer::draw(const SimState& state, unsigned char* frame) {
+	drawBoard(state.ball.centerX, state.ball.centerY, state.ball.radius,
+		state.computer.startX, state.computer.startY, state.player.startX, state.player.startY,
+		state.playerScore, state.computerScore, frame);
+}
+
+void Rasterizer::drawBatch(const BatchWorld& world, unsigned char* frames, int stride) {
+	const int* ballX = world.getBallX();
+	const int* ballY = world.getBallY();
+	const int* computerX = world.getComputerX();
+	const int* playerX = world.getPlayerX();
+	const int* playerScore = world.getPlayerScore();
+	const int* computerScore = world.getComputerScore();
+	for (int i = 0; i < world.getCount(); i++) {
+		// stickies of the batch never leave their row
+		drawBoard(ballX[i], ballY[i], toSubpixels(BALL_RADIUS),
+			computerX[i], toSubpixels(COMPUTER_START_Y), playerX[i], toSubpixels(PLAYER_START_Y),
+			playerScore[i], computerScore[i], frames + (size_t)i * stride);
+	}
+}
+
+void Rasterizer::drawBoard(int ballX, int ballY, int radius, int computerX, int computerY,
+	int playerX, int playerY, int playerScore, int computerScore, unsigned char* frame) {
+	memset(frame, 0, getFrameSize());
+	// score band, computer points on the left, player points on the right
+	for (int i = 0; i < computerScore && i < SCORE; i++) {
+		int left = PIP_GAP + i * (PIP_SIZE + PIP_GAP);
+		fillRect(toSubpixels(left), toSubpixels(PIP_TOP), toSubpixels(left + PIP_SIZE),
+			toSubpixels(PIP_TOP + PIP_SIZE), PATTERN_SCORE, frame);
+	}
+	for (int i = 0; i < playerScore && i < SCORE; i++) {
+		int right = WINDOW_WIDTH - PIP_GAP - i * (PIP_SIZE + PIP_GAP);
+		fillRect(toSubpixels(right - PIP_SIZE), toSubpixels(PIP_TOP), toSubpixels(right),
+			toSubpixels(PIP_TOP + PIP_SIZE), PATTERN_SCORE, frame);
+	}
+	fillRect(toSubpixels(GAME_AREA_LEFT), toSubpixels(GAME_AREA_TOP - 1), toSubpixels(GAME_AREA_RIGHT),
+		toSubpixels(GAME_AREA_TOP), PATTERN_BOARD, frame);
+	// stickies and ball
+	fillRect(computerX, computerY, computerX + toSubpixels(STICKY_WIDTH), computerY + toSubpixels(STICKY_HEIGHT),
+		PATTERN_COMPUTER, frame);
+	fillRect(playerX, playerY, playerX + toSubpixels(STICKY_WIDTH), playerY + toSubpixels(STICKY_HEIGHT),
+		PATTERN_PLAYER, frame);
+	fillCircle(ballX, ballY, radius, PATTERN_BALL, frame);
+}
+
+void Rasterizer::fillRect(int left, int top, int right, int bottom, Pattern pattern, unsigned char* frame) {
+	int x0 = toPixel(left, mScaleX);
+	int x1 = toPixel(right, mScaleX);
+	int y0 = toPixel(top, mScaleY);
+	int y1 = toPixel(bottom, mScaleY);
+	x1 = x1 > x0 ? x1 : x0 + 1;
+	y1 = y1 > y0 ? y1 : y0 + 1;
+	x0 = clampPixel(x0, mWidth);
+	x1 = clampPixel(x1, mWidth);
+	y0 = clampPixel(y0, mHeight);
+	y1 = clampPixel(y1, mHeight);
+	int pitch = mWidth * mFormat;
+	for (int y = y0; y < y1; y++) {
+		fillSpan(frame + y * pitch, x0, x1, pattern);
+	}
+}
+
+void Rasterizer::fillCircle(int x, int y, int radius, Pattern pattern, unsigned char* frame) {
+	// rows whose center lies inside the circle, each a span around x
+	int y0 = clampPixel((int)floorf((y - radius) * mScaleY), mHeight);
+	int y1 = clampPixel((int)ceilf((y + radius) * mScaleY), mHeight);
+	int pitch = mWidth * mFormat;
+	bool drawn = false;
+	float r2 = (float)radius * radius;
+	for (int row = y0; row < y1; row++) {
+		float dy = (row + 0.5f) / mScaleY - y;
+		float left = r2 - dy * dy;
+		if (left < 0.0f) {
+			continue;
+		}
+		float half = sqrtf(left);
+		int x0 = (int)((x - half) * mScaleX + 0.5f);
+		int x1 = (int)((x + half) * mScaleX + 0.5f);
+		x1 = x1 > x0 ? x1 : x0 + 1;
+		fillSpan(frame + row * pitch, clampPixel(x0, mWidth), clampPixel(x1, mWidth), pattern);
+		drawn = true;
+	}
+	// smaller than a row, keep one pixel
+	if (!drawn) {
+		int px = (int)(x * mScaleX);
+		int py = (int)(y * mScaleY);
+		if (px >= 0 && px < mWidth && py >= 0 && py < mHeight) {
+			fillSpan(frame + py * pitch, px, px + 1, pattern);
+		}
+	}
+}
+
+void Rasterizer::fillSpan(unsigned char* row, int from, int to, Pattern pattern) {
+	if (to <= from) {
+		return;
+	}
+	unsigned char* out = row + from * mFormat;
+	int bytes = (to - from) * mFormat;
+	const unsigned char* source = mPatterns[pattern];
+	// whole chunks, a constant size copy is a few vector stores
+	while (bytes >= RASTER_CHUNK) {
+		memcpy(out, source, RASTER_CHUNK);
+		out += RASTER_CHUNK;
+		bytes -= RASTER_CHUNK;
+	}
+	// the chunk starts on a pixel, so its prefix is the right color order too
+	memcpy(out, source, bytes);
+}
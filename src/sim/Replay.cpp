@@ -0,0 +1,219 @@
+//////////////////////////////////////////////////////////////////////////////////
+// Project: Pong
+// File:    Replay.cpp
+//////////////////////////////////////////////////////////////////////////////////
+
+#include <cstdio>
+#include <cstring>
+
+#include "../../include/Replay.h"
+
+// little endian helpers
+static void writeU16(std::vector<unsigned char>& out, unsigned int value) {
+	out.push_back((unsigned char)(value & 0xFF));
+	out.push_back((unsigned char)((value >> 8) & 0xFF));
+}
+
+static void writeU32(std::vector<unsigned char>& out, unsigned int value) {
+	writeU16(out, value & 0xFFFF);
+	writeU16(out, value >> 16);
+}
+
+static unsigned int readU16(const unsigned char* in) {
+	return in[0] | (in[1] << 8);
+}
+
+static unsigned int readU32(const unsigned char* in) {
+	return readU16(in) | (readU16(in + 2) << 16);
+}
+
+unsigned char encodeInput(const TickInput& input) {
+	unsigned char code = 0;
+	if (input.direction < 0) {
+		code |= 1;
+	} else if (input.direction > 0) {
+		code |= 2;
+	}
+	if (input.serve) {
+		code |= 4;
+	}
+	return code;
+}
+
+TickInput decodeInput(unsigned char code) {
+	TickInput input;
+	input.direction = (code & 1) ? -1 : ((code & 2) ? 1 : 0);
+	input.serve = (code & 4) != 0;
+	return input;
+}
+
+ReplayRecorder::ReplayRecorder() {
+	begin(0);
+}
+
+void ReplayRecorder::begin(unsigned int seed, ComputerSkill skill) {
+	mSeed = seed;
+	mSkill = skill;
+	mTicks = 0;
+	mRuns.clear();
+	mRuns.reserve(REPLAY_RESERVED_RUNS * 2);
+}
+
+void ReplayRecorder::record(const TickInput& input) {
+	unsigned char code = encodeInput(input);
+	size_t size = mRuns.size();
+	// extend the last run when the input did not change
+	if (size >= 2 && mRuns[size - 2] == code && mRuns[size - 1] < REPLAY_MAX_RUN) {
+		mRuns[size - 1]++;
+	} else {
+		mRuns.push_back(code);
+		mRuns.push_back(1);
+	}
+	mTicks++;
+}
+
+void ReplayRecorder::truncate(unsigned int ticks) {
+	// drop whole runs from the end, then shorten the last one
+	while (mTicks > ticks && !mRuns.empty()) {
+		unsigned int length = mRuns[mRuns.size() - 1];
+		unsigned int excess = mTicks - ticks;
+		if (length > excess) {
+			mRuns[mRuns.size() - 1] = (unsigned char)(length - excess);
+			mTicks = ticks;
+		} else {
+			mRuns.resize(mRuns.size() - 2);
+			mTicks -= length;
+		}
+	}
+}
+
+bool ReplayRecorder::save(std::string path) {
+	std::vector<unsigned char> header;
+	header.insert(header.end(), REPLAY_MAGIC, REPLAY_MAGIC + 4);
+	writeU16(header, REPLAY_VERSION);
+	writeU32(header, mSeed);
+	header.push_back((unsigned char)mSkill);
+	writeU32(header, mTicks);
+	writeU32(header, (unsigned int)(mRuns.size() / 2));
+
+	FILE* file = fopen(path.c_str(), "wb");
+	if (file == NULL) {
+		printf("Unable to write replay %s!\n", path.c_str());
+		return false;
+	}
+	bool success = fwrite(&header[0], 1, header.size(), file) == header.size();
+	if (success && !mRuns.empty()) {
+		success = fwrite(&mRuns[0], 1, mRuns.size(), file) == mRuns.size();
+	}
+	fclose(file);
+	if (!success) {
+		printf("Unable to write replay %s!\n", path.c_str());
+	}
+	return success;
+}
+
+unsigned int ReplayRecorder::getTickCount() {
+	return mTicks;
+}
+
+ReplayPlayer::ReplayPlayer() {
+	mSeed = 0;
+	mSkill = SKILL_CLASSIC;
+	mTicks = 0;
+	rewind();
+}
+
+bool ReplayPlayer::load(std::string path) {
+	mRuns.clear();
+	mTicks = 0;
+	rewind();
+
+	FILE* file = fopen(path.c_str(), "rb");
+	if (file == NULL) {
+		printf("Unable to open replay %s!\n", path.c_str());
+		return false;
+	}
+	unsigned char header[REPLAY_HEADER_SIZE];
+	if (fread(header, 1, REPLAY_HEADER_SIZE, file) != REPLAY_HEADER_SIZE ||
+		memcmp(header, REPLAY_MAGIC, 4) != 0 || readU16(header + 4) != REPLAY_VERSION) {
+		printf("Replay %s is not a version %d replay!\n", path.c_str(), REPLAY_VERSION);
+		fclose(file);
+		return false;
+	}
+	mSeed = readU32(header + 6);
+	if (header[10] > SKILL_HARD) {
+		printf("Replay %s has an unknown computer skill!\n", path.c_str());
+		fclose(file);
+		return false;
+	}
+	mSkill = (ComputerSkill)header[10];
+	unsigned int ticks = readU32(header + 11);
+	unsigned int runs = readU32(header + 15);
+	mRuns.resize(runs * 2);
+	bool success = runs == 0 || fread(&mRuns[0], 1, mRuns.size(), file) == mRuns.size();
+	fclose(file);
+	if (!success) {
+		printf("Replay %s is truncated!\n", path.c_str());
+		mRuns.clear();
+		return false;
+	}
+	mTicks = ticks;
+	return true;
+}
+
+bool ReplayPlayer::next(TickInput* input) {
+	while (mLeft == 0) {
+		// skip to the next run
+		if (mRun + 2 > mRuns.size()) {
+			return false;
+		}
+		mLeft = mRuns[mRun + 1];
+		mRun += 2;
+	}
+	*input = decodeInput(mRuns[mRun - 2]);
+	mLeft--;
+	return true;
+}
+
+void ReplayPlayer::rewind() {
+	mRun = 0;
+	mLeft = 0;
+}
+
+unsigned int ReplayPlayer::getSeed() {
+	return mSeed;
+}
+
+ComputerSkill ReplayPlayer::getSkill() {
+	return mSkill;
+}
+
+unsigned int ReplayPlayer::getTickCount() {
+	return mTicks;
+}
+
+ReplayStats playReplay(Simulation& sim, ReplayPlayer& replay) {
+	ReplayStats stats;
+	memset(&stats, 0, sizeof(stats));
+	sim.setComputerSkill(replay.getSkill());
+	sim.reset();
+	replay.rewind();
+	TickInput input;
+	while (replay.next(&input)) {
+		sim.applyInput(input);
+		TickResult result = sim.step();
+		stats.ticks++;
+		// same as Game(), score starts over after a match
+		if (result == TICK_PLAYER_WIN || result == TICK_COMPUTER_WIN) {
+			if (result == TICK_PLAYER_WIN) {
+				stats.playerWins++;
+			} else {
+				stats.computerWins++;
+			}
+			sim.resetScore();
+		}
+	}
+	stats.playerScore = sim.getState().playerScore;
+	stats.computerScore = sim.getState().computerScore;
+	return stats;
+}
@@ -0,0 +1,37 @@
+//////////////////////////////////////////////////////////////////////////////////
+// Project: Pong
+// File:    Rewind.cpp
+//////////////////////////////////////////////////////////////////////////////////
+
+#include "../../include/Rewind.h"
+
+SnapshotRing::SnapshotRing() {
+	clear();
+}
+
+void SnapshotRing::clear() {
+	mNext = 0;
+	mCount = 0;
+}
+
+void SnapshotRing::push(const GameSnapshot& snapshot) {
+	mSnapshots[mNext] = snapshot;
+	mNext = (mNext + 1) % REWIND_TICKS;
+	if (mCount < REWIND_TICKS) {
+		mCount++;
+	}
+}
+
+bool SnapshotRing::pop(GameSnapshot* snapshot) {
+	if (mCount == 0) {
+		return false;
+	}
+	mNext = (mNext + REWIND_TICKS - 1) % REWIND_TICKS;
+	mCount--;
+	*snapshot = mSnapshots[mNext];
+	return true;
+}
+
+int SnapshotRing::getCount() {
+	return mCount;
+}
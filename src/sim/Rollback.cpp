@@ -0,0 +1,207 @@
+//////////////////////////////////////////////////////////////////////////////////
+// Project: Pong
+// File:    Rollback.cpp
+//////////////////////////////////////////////////////////////////////////////////
+
+#include "../../include/Rollback.h"
+#include "../../include/Replay.h"
+
+// no tick waits for resimulation
+const unsigned int NO_ROLLBACK = 0xFFFFFFFF;
+
+static int slotOf(unsigned int tick) {
+	return (int)(tick & (ROLLBACK_RING - 1));
+}
+
+RollbackSession::RollbackSession() {
+	begin(SIDE_PLAYER);
+}
+
+void RollbackSession::begin(StickySide localSide) {
+	mSim.reset();
+	mLocalSide = localSide;
+	mTick = 0;
+	mConfirmed = 0;
+	mLastRemoteInput = 0;
+	mLocalAck = 0;
+	mReported = 0;
+	mRollbackFrom = NO_ROLLBACK;
+	mRemoteTick = 0;
+	mLocalAdvantage = 0;
+	mRemoteAdvantage = 0;
+	mSyncWait = 0;
+	mRollbackCount = 0;
+	mMaxRollback = 0;
+	for (int i = 0; i < ROLLBACK_RING; i++) {
+		mLocalInputs[i] = 0;
+		mRemoteInputs[i] = 0;
+		mRemoteTicks[i] = NO_ROLLBACK;
+		mUsedInputs[i] = 0;
+		mResults[i] = TICK_NONE;
+	}
+	mSnapshots[slotOf(0)] = mSim.getState();
+}
+
+bool RollbackSession::canAdvance() {
+	// snapshots and local inputs still needed must stay in the rings
+	// remote input may also be ahead of us, the difference is signed
+	return (int)(mTick - mConfirmed) < ROLLBACK_MAX_PREDICTION &&
+		(int)(mTick - mLocalAck) < ROLLBACK_MAX_PREDICTION;
+}
+
+void RollbackSession::advance(const TickInput& local) {
+	mLocalInputs[slotOf(mTick)] = encodeInput(local);
+	simulate(mTick);
+	mTick++;
+}
+
+void RollbackSession::addRemoteInput(unsigned int tick, const TickInput& input) {
+	// known already, or too far ahead to keep
+	if (tick < mConfirmed || tick - mConfirmed >= (unsigned int)ROLLBACK_RING) {
+		return;
+	}
+	int slot = slotOf(tick);
+	if (mRemoteTicks[slot] == tick) {
+		return;
+	}
+	unsigned char code = encodeInput(input);
+	mRemoteTicks[slot] = tick;
+	mRemoteInputs[slot] = code;
+	// simulated with a wrong guess
+	if (tick < mTick && mUsedInputs[slot] != code && tick < mRollbackFrom) {
+		mRollbackFrom = tick;
+	}
+	while (mRemoteTicks[slotOf(mConfirmed)] == mConfirmed) {
+		mLastRemoteInput = mRemoteInputs[slotOf(mConfirmed)];
+		mConfirmed++;
+	}
+}
+
+int RollbackSession::resimulate() {
+	if (mRollbackFrom == NO_ROLLBACK) {
+		return 0;
+	}
+	int count = (int)(mTick - mRollbackFrom);
+	mSim.getState() = mSnapshots[slotOf(mRollbackFrom)];
+	for (unsigned int tick = mRollbackFrom; tick < mTick; tick++) {
+		simulate(tick);
+	}
+	mRollbackFrom = NO_ROLLBACK;
+	mRollbackCount++;
+	if (count > mMaxRollback) {
+		mMaxRollback = count;
+	}
+	return count;
+}
+
+void RollbackSession::setLocalAck(unsigned int tick) {
+	if (tick > mLocalAck && tick <= mTick) {
+		mLocalAck = tick;
+	}
+}
+
+void RollbackSession::setRemoteTick(unsigned int tick, int advantage) {
+	// packets may arrive out of order
+	if (tick < mRemoteTick) {
+		return;
+	}
+	mRemoteTick = tick;
+	mLocalAdvantage = (int)(mTick - tick);
+	mRemoteAdvantage = advantage;
+}
+
+bool RollbackSession::shouldWait() {
+	if (mSyncWait > 0) {
+		mSyncWait--;
+		return false;
+	}
+	// both sides see the same latency, half the difference is how far we are ahead
+	if ((mLocalAdvantage - mRemoteAdvantage) / 2 >= 1) {
+		mSyncWait = ROLLBACK_SYNC_INTERVAL;
+		return true;
+	}
+	return false;
+}
+
+TickResult RollbackSession::pollConfirmedResult() {
+	// ticks with known input on both sides never change again
+	while (mReported < mConfirmed && mReported < mTick) {
+		TickResult result = (TickResult)mResults[slotOf(mReported)];
+		mReported++;
+		if (result == TICK_PLAYER_WIN || result == TICK_COMPUTER_WIN) {
+			return result;
+		}
+	}
+	return TICK_NONE;
+}
+
+unsigned int RollbackSession::getTick() {
+	return mTick;
+}
+
+unsigned int RollbackSession::getConfirmedTick() {
+	return mConfirmed;
+}
+
+unsigned int RollbackSession::getLocalAck() {
+	return mLocalAck;
+}
+
+int RollbackSession::getAdvantage() {
+	return mLocalAdvantage;
+}
+
+TickInput RollbackSession::getLocalInput(unsigned int tick) {
+	return decodeInput(mLocalInputs[slotOf(tick)]);
+}
+
+StickySide RollbackSession::getLocalSide() {
+	return mLocalSide;
+}
+
+const SimState& RollbackSession::getState() {
+	return mSim.getState();
+}
+
+const SimState& RollbackSession::getPreviousState() {
+	return mSnapshots[slotOf(mTick > 0 ? mTick - 1 : 0)];
+}
+
+int RollbackSession::getRollbackCount() {
+	return mRollbackCount;
+}
+
+int RollbackSession::getMaxRollback() {
+	return mMaxRollback;
+}
+
+unsigned char RollbackSession::remoteInput(unsigned int tick) {
+	int slot = slotOf(tick);
+	if (mRemoteTicks[slot] == tick) {
+		return mRemoteInputs[slot];
+	}
+	// guess the remote player keeps the direction, a serve is never guessed
+	TickInput last = decodeInput(mLastRemoteInput);
+	last.serve = false;
+	return encodeInput(last);
+}
+
+void RollbackSession::simulate(unsigned int tick) {
+	int slot = slotOf(tick);
+	mSnapshots[slot] = mSim.getState();
+	unsigned char remote = remoteInput(tick);
+	mUsedInputs[slot] = remote;
+	TickInput local = decodeInput(mLocalInputs[slot]);
+	TickInput other = decodeInput(remote);
+	if (mLocalSide == SIDE_PLAYER) {
+		mSim.applyInputs(local, other);
+	} else {
+		mSim.applyInputs(other, local);
+	}
+	TickResult result = mSim.advance();
+	// same as Game(), score starts over after a match
+	if (result == TICK_PLAYER_WIN || result == TICK_COMPUTER_WIN) {
+		mSim.resetScore();
+	}
+	mResults[slot] = (unsigned char)result;
+}
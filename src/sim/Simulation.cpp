@@ -0,0 +1,278 @@
+//////////////////////////////////////////////////////////////////////////////////
+// Project: Pong
+// File:    Simulation.cpp
+//////////////////////////////////////////////////////////////////////////////////
+
+#include "../../include/Simulation.h"
+#include "../../include/Sweep.h"
+#include "../../include/Policy.h"
+
+Simulation::Simulation()
+{
+	mComputerSkill = SKILL_CLASSIC;
+	reset();
+}
+
+void Simulation::reset() {
+	// ball
+	mState.ball.centerX = toSubpixels(BALL_START_X);
+	mState.ball.centerY = toSubpixels(BALL_START_Y);
+	mState.ball.velocityX = 0;
+	mState.ball.velocityY = 0;
+	mState.ball.radius = toSubpixels(BALL_RADIUS);
+	// computer sticky
+	mState.computer.startX = toSubpixels(COMPUTER_START_X);
+	mState.computer.startY = toSubpixels(COMPUTER_START_Y);
+	mState.computer.velocityX = 0;
+	mState.computer.velocityY = 0;
+	mState.computer.width = toSubpixels(STICKY_WIDTH);
+	mState.computer.height = toSubpixels(STICKY_HEIGHT);
+	// player sticky
+	mState.player.startX = toSubpixels(PLAYER_START_X);
+	mState.player.startY = toSubpixels(PLAYER_START_Y);
+	mState.player.velocityX = 0;
+	mState.player.velocityY = 0;
+	mState.player.width = toSubpixels(STICKY_WIDTH);
+	mState.player.height = toSubpixels(STICKY_HEIGHT);
+	// score
+	mState.ballSpeed = BALL_INIT_VELOCITY;
+	mState.start = true;
+	resetScore();
+}
+
+void Simulation::resetScore() {
+	mState.playerScore = 0;
+	mState.computerScore = 0;
+}
+
+void Simulation::resetBall() {
+	// reset ball and start flag
+	mState.ball.centerX = toSubpixels(BALL_START_X);
+	mState.ball.centerY = toSubpixels(BALL_START_Y);
+	mState.ball.velocityX = 0;
+	mState.ball.velocityY = 0;
+	mState.ballSpeed = BALL_INIT_VELOCITY;
+	mState.start = true;
+}
+
+void Simulation::serve(int velX) {
+	if (mState.start) {
+		mState.start = false;
+		mState.ball.velocityX = velX;
+		mState.ball.velocityY = mState.ballSpeed;
+	}
+}
+
+void Simulation::setPlayerVelocity(int velX) {
+	mState.player.velocityX = velX;
+	mState.player.velocityY = 0;
+}
+
+void Simulation::setComputerVelocity(int velX) {
+	mState.computer.velocityX = velX;
+	mState.computer.velocityY = 0;
+}
+
+void Simulation::applyInput(const TickInput& input) {
+	setPlayerVelocity(input.direction * STICKY_VELOCITY);
+	if (input.serve) {
+		serve();
+	}
+}
+
+void Simulation::applyInputs(const TickInput& player, const TickInput& computer) {
+	setPlayerVelocity(player.direction * STICKY_VELOCITY);
+	setComputerVelocity(computer.direction * STICKY_VELOCITY);
+	// either player may serve
+	if (player.serve || computer.serve) {
+		serve();
+	}
+}
+
+void Simulation::changePlayerStickySpeed() {
+	StickyState& player = mState.player;
+	const BallState& ball = mState.ball;
+	if (ball.velocityY > 0 && ball.centerY < player.startY) {
+		// count player sticky left and right
+		int left = player.startX;
+		int right = player.startX + player.width;
+		if (ball.centerX <= left) {
+			setPlayerVelocity(-STICKY_VELOCITY);
+		} else if (ball.centerX >= right) {
+			setPlayerVelocity(STICKY_VELOCITY);
+		} else {
+			setPlayerVelocity(0);
+		}
+	} else {
+		setPlayerVelocity(0);
+	}
+}
+
+void Simulation::changeComputerStickySpeed() {
+	StickyState& computer = mState.computer;
+	const BallState& ball = mState.ball;
+	computer.velocityY = 0;
+	if (mComputerSkill != SKILL_CLASSIC) {
+		// move to where the ball will arrive
+		computer.velocityX = predictorDirection(mState, SIDE_COMPUTER, PREDICTOR_SKILLS[mComputerSkill]) * STICKY_VELOCITY;
+	} else if (ball.velocityY < 0 &&
+		ball.centerY > computer.startY + computer.height) {
+		// count computer sticky left and right
+		int left = computer.startX;
+		int right = computer.startX + computer.width;
+		if (ball.centerX <= left) {
+			computer.velocityX = -STICKY_VELOCITY;
+		} else if (ball.centerX >= right) {
+			computer.velocityX = STICKY_VELOCITY;
+		} else {
+			computer.velocityX = 0;
+		}
+	} else {
+		computer.velocityX = 0;
+	}
+}
+
+void Simulation::setComputerSkill(ComputerSkill skill) {
+	mComputerSkill = skill;
+}
+
+ComputerSkill Simulation::getComputerSkill() const {
+	return mComputerSkill;
+}
+
+TickResult Simulation::changeBallSpeed() {
+	TickResult result = TICK_NONE;
+	BallState& ball = mState.ball;
+	const StickyState& player = mState.player;
+	const StickyState& computer = mState.computer;
+	int y = ball.centerY;
+	int radius = ball.radius;
+	// check game win or lose score
+	if (y + radius < 0) {
+		// player get score
+		mState.playerScore++;
+		result = mState.playerScore >= SCORE ? TICK_PLAYER_WIN : TICK_PLAYER_SCORE;
+		resetBall();
+	}
+	if (y - radius > toSubpixels(WINDOW_HEIGHT)) {
+		// computer get score
+		mState.computerScore++;
+		result = mState.computerScore >= SCORE ? TICK_COMPUTER_WIN : TICK_COMPUTER_SCORE;
+		resetBall();
+	}
+	// move and bounce off walls and stickies, time of impact keeps fast balls from tunneling
+	float ballX = (float)ball.centerX;
+	float ballY = (float)ball.centerY;
+	sweepBall(&ballX, &ballY, &ball.velocityX, &ball.velocityY,
+		(float)player.startX, (float)player.startY, player.velocityX,
+		(float)computer.startX, (float)computer.startY, computer.velocityX);
+	ball.centerX = roundSubpixel(ballX);
+	ball.centerY = roundSubpixel(ballY);
+	return result;
+}
+
+TickResult Simulation::step() {
+	changeComputerStickySpeed();
+	return advance();
+}
+
+TickResult Simulation::advance() {
+	// player sticky move
+	if (!checkWallCollision(mState.player)) {
+		mState.player.startX += mState.player.velocityX;
+		mState.player.startY += mState.player.velocityY;
+	}
+	// computer sticky move
+	if (!checkWallCollision(mState.computer)) {
+		mState.computer.startX += mState.computer.velocityX;
+		mState.computer.startY += mState.computer.velocityY;
+	}
+	// ball move
+	return changeBallSpeed();
+}
+
+SimState& Simulation::getState() {
+	return mState;
+}
+
+const SimState& Simulation::getState() const {
+	return mState;
+}
+
+bool checkWallCollision(const StickyState& sticky) {
+	int left = sticky.startX + sticky.velocityX;
+	int right = sticky.startX + sticky.width + sticky.velocityX;
+	if (left < toSubpixels(GAME_AREA_LEFT) || right > toSubpixels(GAME_AREA_RIGHT)) {
+		return true;
+	}
+	return false;
+}
+
+bool checkWallCollision(const BallState& ball) {
+	int x = ball.centerX + ball.velocityX;
+	int y = ball.centerY + ball.velocityY;
+	int radius = ball.radius;
+	if (x - radius < toSubpixels(GAME_AREA_LEFT) || x + radius > toSubpixels(GAME_AREA_RIGHT) ||
+		y - radius < toSubpixels(GAME_AREA_TOP) || y + radius > toSubpixels(GAME_AREA_BOTTOM)) {
+		return true;
+	}
+	return false;
+}
+
+bool checkEntityCollision(const StickyState& sticky, const BallState& ball) {
+	// get ball position
+	int ballX = ball.centerX + ball.velocityX;
+	int ballY = ball.centerY + ball.velocityY;
+	int radius = ball.radius;
+	// get closest point to ball on sticky
+	int stickyX = ballX;
+	int stickyY = ballY;
+	if (ballX < sticky.startX) {
+		stickyX = sticky.startX;
+	}
+	if (ballY < sticky.startY) {
+		stickyY = sticky.startY;
+	}
+	if (ballX > sticky.startX + sticky.width) {
+		stickyX = sticky.startX + sticky.width;
+	}
+	if (ballY > sticky.startY + sticky.height) {
+		stickyY = sticky.startY + sticky.height;
+	}
+
+	// count distance square, subpixel squares need 64 bits
+	long long dx = stickyX - ballX;
+	long long dy = stickyY - ballY;
+	if (dx * dx + dy * dy < (long long)radius * radius) {
+		return true;
+	}
+	return false;
+}
+
+int nextServeVelocity(unsigned int* seed) {
+	*seed = *seed * 1103515245u + 12345u;
+	int speed = (int)((*seed >> 16) % (2 * SERVE_MAX_SPEED_X + 1)) - SERVE_MAX_SPEED_X;
+	return speed * SPEED_SCALE;
+}
+
+MatchStats playMatch(Simulation& sim, unsigned int seed, long long maxTicks) {
+	MatchStats stats;
+	stats.ticks = 0;
+	stats.stalledRallies = 0;
+	sim.reset();
+	while (stats.ticks < maxTicks) {
+		// serve with a random horizontal speed
+		if (sim.getState().start) {
+			sim.serve(nextServeVelocity(&seed));
+		}
+		sim.changePlayerStickySpeed();
+		TickResult result = sim.step();
+		stats.ticks++;
+		if (result == TICK_PLAYER_WIN || result == TICK_COMPUTER_WIN) {
+			break;
+		}
+	}
+	stats.playerScore = sim.getState().playerScore;
+	stats.computerScore = sim.getState().computerScore;
+	return stats;
+}
@@ -0,0 +1,72 @@
+//////////////////////////////////////////////////////////////////////////////////
+// Project: Pong
+// File:    TaskPool.cpp
+//////////////////////////////////////////////////////////////////////////////////
+
+#include <thread>
+
+#include "../../include/TaskPool.h"
+
+TaskPool::TaskPool(int threads) :
+	mQueues(threads > 0 ? threads : (std::thread::hardware_concurrency() > 0 ? std::thread::hardware_concurrency() : 1)) {
+	mThreadCount = (int)mQueues.size();
+}
+
+void TaskPool::run(int count, TaskJob job, void* context) {
+	// hand out contiguous blocks, stealing evens out what is left
+	for (int w = 0; w < mThreadCount; w++) {
+		int begin = (int)((long long)count * w / mThreadCount);
+		int end = (int)((long long)count * (w + 1) / mThreadCount);
+		std::lock_guard<std::mutex> guard(mQueues[w].lock);
+		mQueues[w].tasks.clear();
+		for (int i = begin; i < end; i++) {
+			mQueues[w].tasks.push_back(i);
+		}
+	}
+
+	std::vector<std::thread> threads;
+	for (int w = 1; w < mThreadCount; w++) {
+		threads.push_back(std::thread(&TaskPool::work, this, w, job, context));
+	}
+	work(0, job, context);
+	for (size_t i = 0; i < threads.size(); i++) {
+		threads[i].join();
+	}
+}
+
+int TaskPool::getThreadCount() {
+	return mThreadCount;
+}
+
+void TaskPool::work(int worker, TaskJob job, void* context) {
+	int index;
+	// no task adds new ones, so once every queue is empty the run is over
+	while (pop(worker, &index) || steal(worker, &index)) {
+		job(index, worker, context);
+	}
+}
+
+bool TaskPool::pop(int worker, int* index) {
+	WorkerQueue& queue = mQueues[worker];
+	std::lock_guard<std::mutex> guard(queue.lock);
+	if (queue.tasks.empty()) {
+		return false;
+	}
+	*index = queue.tasks.back();
+	queue.tasks.pop_back();
+	return true;
+}
+
+bool TaskPool::steal(int worker, int* index) {
+	// visit the others starting with the next worker, spreads the thieves out
+	for (int i = 1; i < mThreadCount; i++) {
+		WorkerQueue& queue = mQueues[(worker + i) % mThreadCount];
+		std::lock_guard<std::mutex> guard(queue.lock);
+		if (!queue.tasks.empty()) {
+			*index = queue.tasks.front();
+			queue.tasks.pop_front();
+			return true;
+		}
+	}
+	return false;
+}
@@ -0,0 +1,235 @@
+//////////////////////////////////////////////////////////////////////////////////
+// Project: Pong
+// File:    Tournament.cpp
+//////////////////////////////////////////////////////////////////////////////////
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#include "../../include/Tournament.h"
+#include "../../include/TaskPool.h"
+
+Tournament::Tournament(const std::vector<const PolicyEntry*>& policies) :
+	mPolicies(policies) {
+	int n = (int)mPolicies.size();
+	mMaxTicks = TOURNAMENT_MAX_TICKS;
+	mMaxRallyTicks = TOURNAMENT_MAX_RALLY_TICKS;
+	mWins.assign(n * n, 0);
+	mDraws.assign(n * n, 0);
+	mGames.assign(n * n, 0);
+	mStalled.assign(n * n, 0);
+	mElo.assign(n, ELO_BASE);
+	mTicks = 0;
+	mThreadCount = 0;
+}
+
+void Tournament::run(const TournamentSettings& settings) {
+	int n = (int)mPolicies.size();
+	mMaxTicks = settings.maxTicks;
+	mMaxRallyTicks = settings.maxRallyTicks;
+
+	// schedule, both sides of every pair get the same serves
+	mMatches.clear();
+	for (int i = 0; i < n; i++) {
+		for (int j = 0; j < n; j++) {
+			if (i == j) {
+				continue;
+			}
+			for (int g = 0; g < settings.games; g++) {
+				Match match;
+				match.player = i;
+				match.computer = j;
+				match.seed = settings.seed + g;
+				memset(&match.stats, 0, sizeof(match.stats));
+				mMatches.push_back(match);
+			}
+		}
+	}
+
+	TaskPool pool(settings.threads);
+	mThreadCount = pool.getThreadCount();
+	pool.run((int)mMatches.size(), playJob, this);
+
+	// tally in schedule order so the tables do not depend on the threads
+	mWins.assign(n * n, 0);
+	mDraws.assign(n * n, 0);
+	mGames.assign(n * n, 0);
+	mStalled.assign(n * n, 0);
+	mTicks = 0;
+	for (size_t m = 0; m < mMatches.size(); m++) {
+		const Match& match = mMatches[m];
+		int p = match.player;
+		int c = match.computer;
+		mGames[p * n + c]++;
+		mGames[c * n + p]++;
+		mStalled[p * n + c] += match.stats.stalledRallies;
+		mStalled[c * n + p] += match.stats.stalledRallies;
+		if (match.stats.playerScore >= SCORE) {
+			mWins[p * n + c]++;
+		} else if (match.stats.computerScore >= SCORE) {
+			mWins[c * n + p]++;
+		} else {
+			mDraws[p * n + c]++;
+			mDraws[c * n + p]++;
+		}
+		mTicks += match.stats.ticks;
+	}
+	fitElo();
+}
+
+void Tournament::playJob(int index, int /*worker*/, void* context) {
+	Tournament* tournament = (Tournament*)context;
+	Match& match = tournament->mMatches[index];
+	// match state lives on the worker stack, only the result slot is shared
+	Simulation sim;
+	match.stats = playPolicyMatch(sim, tournament->mPolicies[match.player]->policy,
+		tournament->mPolicies[match.computer]->policy, match.seed, tournament->mMaxTicks,
+		tournament->mMaxRallyTicks);
+}
+
+void Tournament::fitElo() {
+	int n = (int)mPolicies.size();
+	// one made up draw per pair keeps a perfect record from running off to infinity
+	std::vector<double> points(n, 0.0);
+	for (int i = 0; i < n; i++) {
+		for (int j = 0; j < n; j++) {
+			if (i != j) {
+				points[i] += mWins[i * n + j] + 0.5 * mDraws[i * n + j] + 0.5;
+			}
+		}
+	}
+
+	// minorization maximization, strength of i is points over expected games
+	std::vector<double> strength(n, 1.0);
+	std::vector<double> next(n, 1.0);
+	for (int round = 0; round < ELO_ROUNDS; round++) {
+		for (int i = 0; i < n; i++) {
+			double sum = 0.0;
+			for (int j = 0; j < n; j++) {
+				if (i != j) {
+					sum += (mGames[i * n + j] + 1) / (strength[i] + strength[j]);
+				}
+			}
+			next[i] = sum > 0.0 ? points[i] / sum : 1.0;
+		}
+		// keep the geometric mean at 1 so the ratings center on ELO_BASE
+		double logMean = 0.0;
+		for (int i = 0; i < n; i++) {
+			logMean += log(next[i]);
+		}
+		double scale = exp(-logMean / (n > 0 ? n : 1));
+		for (int i = 0; i < n; i++) {
+			strength[i] = next[i] * scale;
+		}
+	}
+	for (int i = 0; i < n; i++) {
+		mElo[i] = ELO_BASE + 400.0 * log10(strength[i]);
+	}
+}
+
+int Tournament::getPolicyCount() {
+	return (int)mPolicies.size();
+}
+
+const PolicyEntry* Tournament::getPolicy(int i) {
+	return mPolicies[i];
+}
+
+int Tournament::getWins(int i, int j) {
+	return mWins[i * mPolicies.size() + j];
+}
+
+int Tournament::getDraws(int i, int j) {
+	return mDraws[i * mPolicies.size() + j];
+}
+
+int Tournament::getGames(int i, int j) {
+	return mGames[i * mPolicies.size() + j];
+}
+
+int Tournament::getStalledRallies(int i, int j) {
+	return mStalled[i * mPolicies.size() + j];
+}
+
+double Tournament::getElo(int i) {
+	return mElo[i];
+}
+
+long long Tournament::getTicks() {
+	return mTicks;
+}
+
+int Tournament::getThreadCount() {
+	return mThreadCount;
+}
+
+void Tournament::print() {
+	int n = (int)mPolicies.size();
+
+	// ratings, best first
+	std::vector<int> order;
+	for (int i = 0; i < n; i++) {
+		order.push_back(i);
+	}
+	for (int i = 1; i < n; i++) {
+		for (int j = i; j > 0 && mElo[order[j]] > mElo[order[j - 1]]; j--) {
+			int swap = order[j];
+			order[j] = order[j - 1];
+			order[j - 1] = swap;
+		}
+	}
+	printf("%-4s %-16s %8s %8s %8s %8s\n", "rank", "policy", "elo", "wins", "draws", "losses");
+	for (int r = 0; r < n; r++) {
+		int i = order[r];
+		int wins = 0;
+		int draws = 0;
+		int losses = 0;
+		for (int j = 0; j < n; j++) {
+			wins += mWins[i * n + j];
+			draws += mDraws[i * n + j];
+			losses += mWins[j * n + i];
+		}
+		printf("%-4d %-16s %8.1f %8d %8d %8d\n", r + 1, mPolicies[i]->name, mElo[i], wins, draws, losses);
+	}
+
+	// win matrix, wins of the row against the column out of their games
+	printf("\nwins/games, row against column\n");
+	printf("%-16s", "");
+	for (int j = 0; j < n; j++) {
+		printf(" %16s", mPolicies[j]->name);
+	}
+	printf("\n");
+	for (int i = 0; i < n; i++) {
+		printf("%-16s", mPolicies[i]->name);
+		for (int j = 0; j < n; j++) {
+			if (i == j) {
+				printf(" %16s", "-");
+			} else {
+				char cell[32];
+				snprintf(cell, sizeof(cell), "%d/%d", mWins[i * n + j], mGames[i * n + j]);
+				printf(" %16s", cell);
+			}
+		}
+		printf("\n");
+	}
+
+	// rallies no point came out of, the table is symmetric
+	printf("\nrallies served again after the rally tick limit, row against column\n");
+	printf("%-16s", "");
+	for (int j = 0; j < n; j++) {
+		printf(" %16s", mPolicies[j]->name);
+	}
+	printf("\n");
+	for (int i = 0; i < n; i++) {
+		printf("%-16s", mPolicies[i]->name);
+		for (int j = 0; j < n; j++) {
+			if (i == j) {
+				printf(" %16s", "-");
+			} else {
+				printf(" %16d", mStalled[i * n + j]);
+			}
+		}
+		printf("\n");
+	}
+}
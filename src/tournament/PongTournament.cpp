@@ -0,0 +1,96 @@
+//////////////////////////////////////////////////////////////////////////////////
+// Project: Pong
+// File:    PongTournament.cpp
+//////////////////////////////////////////////////////////////////////////////////
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <string>
+
+#include "../../include/Tournament.h"
+
+// PongTournament [--games N] [--seed S] [--max-ticks M] [--max-rally-ticks R] [--threads T] [--policies a,b,c]
+bool parseOptions(int argc, char** argv, TournamentSettings* settings, std::vector<const PolicyEntry*>* policies);
+
+int main(int argc, char** argv) {
+	TournamentSettings settings;
+	std::vector<const PolicyEntry*> policies;
+	if (!parseOptions(argc, argv, &settings, &policies)) {
+		return 1;
+	}
+	if (policies.size() < 2) {
+		printf("A tournament needs at least two policies!\n");
+		return 1;
+	}
+
+	Tournament tournament(policies);
+	std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+	tournament.run(settings);
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+	tournament.print();
+	int n = (int)policies.size();
+	int draws = 0;
+	for (int i = 0; i < n; i++) {
+		for (int j = i + 1; j < n; j++) {
+			draws += tournament.getDraws(i, j);
+		}
+	}
+	printf("\ndraws: %d of %d matches\n", draws, n * (n - 1) * settings.games);
+	printf("matches: %d, threads: %d, ticks: %lld, seconds: %.3f, ticks per second: %.0f\n",
+		n * (n - 1) * settings.games, tournament.getThreadCount(), tournament.getTicks(), seconds,
+		seconds > 0 ? tournament.getTicks() / seconds : 0.0);
+	return 0;
+}
+
+bool parseOptions(int argc, char** argv, TournamentSettings* settings, std::vector<const PolicyEntry*>* policies) {
+	settings->games = 20;
+	settings->seed = (unsigned int)time(0);
+	settings->maxTicks = TOURNAMENT_MAX_TICKS;
+	settings->maxRallyTicks = TOURNAMENT_MAX_RALLY_TICKS;
+	settings->threads = 0;
+	std::string names;
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--games") == 0 && i + 1 < argc) {
+			settings->games = atoi(argv[++i]);
+		} else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+			settings->seed = (unsigned int)strtoul(argv[++i], NULL, 10);
+		} else if (strcmp(argv[i], "--max-ticks") == 0 && i + 1 < argc) {
+			settings->maxTicks = atoll(argv[++i]);
+		} else if (strcmp(argv[i], "--max-rally-ticks") == 0 && i + 1 < argc) {
+			settings->maxRallyTicks = atoll(argv[++i]);
+		} else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+			settings->threads = atoi(argv[++i]);
+		} else if (strcmp(argv[i], "--policies") == 0 && i + 1 < argc) {
+			names = argv[++i];
+		}
+	}
+
+	// whole zoo unless a list was given
+	policies->clear();
+	if (names.empty()) {
+		for (int i = 0; i < POLICY_COUNT; i++) {
+			policies->push_back(&POLICIES[i]);
+		}
+		return true;
+	}
+	size_t start = 0;
+	while (start <= names.size()) {
+		size_t end = names.find(',', start);
+		if (end == std::string::npos) {
+			end = names.size();
+		}
+		std::string name = names.substr(start, end - start);
+		const PolicyEntry* entry = findPolicy(name.c_str());
+		if (entry == NULL) {
+			printf("Unknown policy %s!\n", name.c_str());
+			return false;
+		}
+		policies->push_back(entry);
+		start = end + 1;
+	}
+	return true;
+}